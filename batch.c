@@ -0,0 +1,186 @@
+#include "batch.h"
+#include "rlgl.h"
+#include "raymath.h"
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Atlas layout: 64x64 antialiased disc on the left, 4x4 solid white block on the right
+#define ATLAS_WIDTH 128
+#define ATLAS_HEIGHT 64
+#define CIRCLE_SIZE 64
+#define SOLID_X 64
+
+// UVs of the disc quad, and one texel in the middle of the solid block (no filtering bleed)
+static const float circleU0 = 0.0f;
+static const float circleU1 = (float)CIRCLE_SIZE / ATLAS_WIDTH;
+static const float circleV0 = 0.0f;
+static const float circleV1 = (float)CIRCLE_SIZE / ATLAS_HEIGHT;
+static const float solidU = (SOLID_X + 2.0f) / ATLAS_WIDTH;
+static const float solidV = 2.0f / ATLAS_HEIGHT;
+
+static Texture2D LoadSpriteAtlas(void) {
+    Color *pixels = calloc(ATLAS_WIDTH * ATLAS_HEIGHT, sizeof(Color));
+
+    // Disc with a one texel coverage ramp at the edge so scaled circles stay smooth
+    float radius = CIRCLE_SIZE / 2.0f;
+    for (int y = 0; y < CIRCLE_SIZE; y++) {
+        for (int x = 0; x < CIRCLE_SIZE; x++) {
+            float dx = x + 0.5f - radius;
+            float dy = y + 0.5f - radius;
+            float coverage = radius - sqrtf(dx * dx + dy * dy) + 0.5f;
+            coverage = fmaxf(0.0f, fminf(coverage, 1.0f));
+            pixels[y * ATLAS_WIDTH + x] = (Color){255, 255, 255, (unsigned char)(coverage * 255.0f)};
+        }
+    }
+    for (int y = 0; y < 4; y++) {
+        for (int x = SOLID_X; x < SOLID_X + 4; x++) pixels[y * ATLAS_WIDTH + x] = WHITE;
+    }
+
+    Image image = {pixels, ATLAS_WIDTH, ATLAS_HEIGHT, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+    Texture2D atlas = LoadTextureFromImage(image);
+    SetTextureFilter(atlas, TEXTURE_FILTER_BILINEAR);
+    free(pixels);
+    return atlas;
+}
+
+// Point the default shader's attributes at the interleaved SpriteVertex layout
+static void SetSpriteAttributes(void) {
+    int *locs = rlGetShaderLocsDefault();
+    rlSetVertexAttribute(locs[SHADER_LOC_VERTEX_POSITION], 2, RL_FLOAT, false, sizeof(SpriteVertex), offsetof(SpriteVertex, x));
+    rlEnableVertexAttribute(locs[SHADER_LOC_VERTEX_POSITION]);
+    rlSetVertexAttribute(locs[SHADER_LOC_VERTEX_TEXCOORD01], 2, RL_FLOAT, false, sizeof(SpriteVertex), offsetof(SpriteVertex, u));
+    rlEnableVertexAttribute(locs[SHADER_LOC_VERTEX_TEXCOORD01]);
+    rlSetVertexAttribute(locs[SHADER_LOC_VERTEX_COLOR], 4, RL_UNSIGNED_BYTE, true, sizeof(SpriteVertex), offsetof(SpriteVertex, color));
+    rlEnableVertexAttribute(locs[SHADER_LOC_VERTEX_COLOR]);
+}
+
+// (Re)create the GPU buffer so it holds at least capacity vertices
+static void ReserveGpuBuffer(SpriteBatch *batch, int capacity) {
+    if (batch->vbo) rlUnloadVertexBuffer(batch->vbo);
+    if (batch->vao) rlUnloadVertexArray(batch->vao);
+
+    batch->vao = rlLoadVertexArray();
+    rlEnableVertexArray(batch->vao);
+    batch->vbo = rlLoadVertexBuffer(NULL, capacity * (int)sizeof(SpriteVertex), true);
+    SetSpriteAttributes();
+    rlDisableVertexArray();
+    rlDisableVertexBuffer();
+    batch->gpuCapacity = capacity;
+}
+
+void LoadSpriteBatch(SpriteBatch *batch) {
+    memset(batch, 0, sizeof(*batch));
+    batch->atlas = LoadSpriteAtlas();
+    batch->capacity = 6 * 1024;
+    batch->vertices = malloc(sizeof(SpriteVertex) * batch->capacity);
+    ReserveGpuBuffer(batch, batch->capacity);
+}
+
+void UnloadSpriteBatch(SpriteBatch *batch) {
+    if (batch->vbo) rlUnloadVertexBuffer(batch->vbo);
+    if (batch->vao) rlUnloadVertexArray(batch->vao);
+    UnloadTexture(batch->atlas);
+    free(batch->vertices);
+    memset(batch, 0, sizeof(*batch));
+}
+
+void BeginSpriteBatch(SpriteBatch *batch) {
+    batch->count = 0;
+    batch->layerStart = 0;
+    batch->drawCalls = 0;
+    batch->sprites = 0;
+}
+
+static SpriteVertex *ReserveVertices(SpriteBatch *batch, int count) {
+    if (batch->count + count > batch->capacity) {
+        while (batch->count + count > batch->capacity) batch->capacity *= 2;
+        batch->vertices = realloc(batch->vertices, sizeof(SpriteVertex) * batch->capacity);
+    }
+    SpriteVertex *v = batch->vertices + batch->count;
+    batch->count += count;
+    batch->sprites++;
+    return v;
+}
+
+// Two triangles covering quad a-b-c-d given as top-left, top-right, bottom-right, bottom-left
+// (raylib's winding, so backface culling keeps them)
+static void PutQuad(SpriteVertex *v, Vector2 a, Vector2 b, Vector2 c, Vector2 d,
+                    float u0, float v0, float u1, float v1, Color color) {
+    v[0] = (SpriteVertex){a.x, a.y, u0, v0, color};
+    v[1] = (SpriteVertex){d.x, d.y, u0, v1, color};
+    v[2] = (SpriteVertex){c.x, c.y, u1, v1, color};
+    v[3] = (SpriteVertex){a.x, a.y, u0, v0, color};
+    v[4] = (SpriteVertex){c.x, c.y, u1, v1, color};
+    v[5] = (SpriteVertex){b.x, b.y, u1, v0, color};
+}
+
+void PushSpriteCircle(SpriteBatch *batch, Vector2 center, float radius, Color color) {
+    SpriteVertex *v = ReserveVertices(batch, 6);
+    PutQuad(v, (Vector2){center.x - radius, center.y - radius}, (Vector2){center.x + radius, center.y - radius},
+            (Vector2){center.x + radius, center.y + radius}, (Vector2){center.x - radius, center.y + radius},
+            circleU0, circleV0, circleU1, circleV1, color);
+}
+
+void PushSpriteTriangle(SpriteBatch *batch, Vector2 v1, Vector2 v2, Vector2 v3, Color color) {
+    SpriteVertex *v = ReserveVertices(batch, 3);
+    v[0] = (SpriteVertex){v1.x, v1.y, solidU, solidV, color};
+    v[1] = (SpriteVertex){v2.x, v2.y, solidU, solidV, color};
+    v[2] = (SpriteVertex){v3.x, v3.y, solidU, solidV, color};
+}
+
+void PushSpriteLine(SpriteBatch *batch, Vector2 start, Vector2 end, float thick, Color color) {
+    float dx = end.x - start.x;
+    float dy = end.y - start.y;
+    float length = sqrtf(dx * dx + dy * dy);
+    if (length <= 0.0f) return;
+
+    // Offset both ends by half the thickness along the line normal, same winding as the quads
+    float nx = dy / length * thick * 0.5f;
+    float ny = -dx / length * thick * 0.5f;
+    SpriteVertex *v = ReserveVertices(batch, 6);
+    PutQuad(v, (Vector2){start.x + nx, start.y + ny}, (Vector2){end.x + nx, end.y + ny},
+            (Vector2){end.x - nx, end.y - ny}, (Vector2){start.x - nx, start.y - ny},
+            solidU, solidV, solidU, solidV, color);
+}
+
+void PushSpritePixel(SpriteBatch *batch, Vector2 position, Color color) {
+    SpriteVertex *v = ReserveVertices(batch, 6);
+    PutQuad(v, position, (Vector2){position.x + 1, position.y}, (Vector2){position.x + 1, position.y + 1},
+            (Vector2){position.x, position.y + 1}, solidU, solidV, solidU, solidV, color);
+}
+
+void FlushSpriteLayer(SpriteBatch *batch) {
+    int first = batch->layerStart;
+    int count = batch->count - first;
+    batch->layerStart = batch->count;
+    if (count == 0) return;
+
+    // Anything raylib queued (text, rectangles) must land underneath this layer
+    rlDrawRenderBatchActive();
+
+    if (batch->capacity > batch->gpuCapacity) ReserveGpuBuffer(batch, batch->capacity);
+    rlUpdateVertexBuffer(batch->vbo, batch->vertices + first, count * (int)sizeof(SpriteVertex), first * (int)sizeof(SpriteVertex));
+
+    int *locs = rlGetShaderLocsDefault();
+    float white[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    Matrix mvp = MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection());
+    rlEnableShader(rlGetShaderIdDefault());
+    rlSetUniformMatrix(locs[SHADER_LOC_MATRIX_MVP], mvp);
+    rlSetUniform(locs[SHADER_LOC_COLOR_DIFFUSE], white, SHADER_UNIFORM_VEC4, 1);
+    rlActiveTextureSlot(0);
+    rlEnableTexture(batch->atlas.id);
+
+    if (!rlEnableVertexArray(batch->vao)) {
+        rlEnableVertexBuffer(batch->vbo);
+        SetSpriteAttributes();
+    }
+    rlDrawVertexArray(first, count);
+    batch->drawCalls++;
+
+    rlDisableVertexArray();
+    rlDisableVertexBuffer();
+    rlDisableTexture();
+    rlDisableShader();
+}
@@ -0,0 +1,38 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "raylib.h"
+
+// One vertex of the sprite batch: position, atlas UV and color, 20 bytes
+typedef struct {
+    float x, y;
+    float u, v;
+    Color color;
+} SpriteVertex;
+
+// Batched renderer on top of rlgl. All sprites come from one prebuilt atlas (antialiased
+// circle plus a solid texel for triangles, lines and pixels) and go into one vertex buffer
+// per frame. Each layer (particles, lasers, enemies...) is submitted with a single draw.
+typedef struct {
+    Texture2D atlas;
+    unsigned int vao;           // 0 when vertex arrays are unsupported (WebGL 1 without extension)
+    unsigned int vbo;
+    int gpuCapacity;            // Vertices the GPU buffer can hold
+    SpriteVertex *vertices;     // CPU side of this frame's vertices
+    int count;
+    int capacity;
+    int layerStart;             // First vertex of the layer being built
+    int drawCalls;              // Draws submitted since BeginSpriteBatch
+    int sprites;                // Sprites pushed since BeginSpriteBatch
+} SpriteBatch;
+
+void LoadSpriteBatch(SpriteBatch *batch);       // Needs a GL context (after InitWindow)
+void UnloadSpriteBatch(SpriteBatch *batch);
+void BeginSpriteBatch(SpriteBatch *batch);      // Start of frame, resets vertices and counters
+void FlushSpriteLayer(SpriteBatch *batch);      // Draw everything pushed since the last flush in one call
+void PushSpriteCircle(SpriteBatch *batch, Vector2 center, float radius, Color color);
+void PushSpriteTriangle(SpriteBatch *batch, Vector2 v1, Vector2 v2, Vector2 v3, Color color);
+void PushSpriteLine(SpriteBatch *batch, Vector2 start, Vector2 end, float thick, Color color);
+void PushSpritePixel(SpriteBatch *batch, Vector2 position, Color color);
+
+#endif // BATCH_H
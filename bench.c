@@ -0,0 +1,417 @@
+// Kernel benchmarks: every per-entity loop of a step on its own, at 100 to 1M entities,
+// reported as JSON. Builds natively and with emscripten for node, so both targets run the
+// same scenarios on the same code.
+// Usage: bench [-n maxCount] [-k scenario] [-t seconds] [-j threads] [-o bench.json]
+// Built with -DFASTMATH_COUNT it also has trig_calls, the trig calls one step makes.
+#define _POSIX_C_SOURCE 200809L  // clock_gettime
+#include "world.h"
+#include "jobs.h"
+#include "input.h"
+#include "fastmath.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#if defined(__EMSCRIPTEN__)
+    #define BENCH_TARGET "wasm"
+#else
+    #define BENCH_TARGET "native"
+#endif
+
+static double Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+//----------------------------------------------------------------------------------
+// Scripted touch source: input.c reads raylib's input state, the bench plays fingers
+// landing and lifting instead, so no window or raylib library is needed
+//----------------------------------------------------------------------------------
+#define BENCH_TOUCHES 8             // raylib's MAX_TOUCH_POINTS
+
+static struct {
+    int count;
+    int ids[BENCH_TOUCHES];
+    Vector2 positions[BENCH_TOUCHES];
+} touchScript;
+
+int GetTouchPointCount(void) { return touchScript.count; }
+int GetTouchPointId(int index) { return touchScript.ids[index]; }
+Vector2 GetTouchPosition(int index) { return touchScript.positions[index]; }
+int GetKeyPressed(void) { return 0; }
+bool IsKeyDown(int key) { (void)key; return false; }
+bool IsMouseButtonPressed(int button) { (void)button; return false; }
+bool IsMouseButtonDown(int button) { (void)button; return false; }
+Vector2 GetMousePosition(void) { return (Vector2){0.0f, 0.0f}; }
+Vector2 GetMouseDelta(void) { return (Vector2){0.0f, 0.0f}; }
+float GetMouseWheelMove(void) { return 0.0f; }
+
+bool CheckCollisionPointCircle(Vector2 point, Vector2 center, float radius) {
+    float dx = point.x - center.x, dy = point.y - center.y;
+    return dx * dx + dy * dy <= radius * radius;
+}
+
+bool CheckCollisionPointRec(Vector2 point, Rectangle rec) {
+    return point.x >= rec.x && point.x < rec.x + rec.width && point.y >= rec.y && point.y < rec.y + rec.height;
+}
+
+//----------------------------------------------------------------------------------
+// Scenarios
+//----------------------------------------------------------------------------------
+typedef struct {
+    unsigned int rng;
+    World world;
+    Enemy *enemyTemplate;
+    Laser *lasers;
+    Laser *laserTemplate;
+    SpatialHash grid;
+    Vector2 *points;
+    int *hits;
+    ParticleSystem particles;
+    InputState input;
+    long long steps;
+    long long cachedTrig;
+    char details[160];      // Extra JSON fields for the result, empty for most scenarios
+} BenchState;
+
+static unsigned int BenchRandom(BenchState *state) {
+    unsigned int x = state->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    state->rng = x;
+    return x;
+}
+
+// Playfield scaled so entity density stays at that of 1000 entities on WORLD_WIDTH x WORLD_HEIGHT
+static void BenchPlayfield(int count, int *width, int *height) {
+    float scale = sqrtf(count > 1000 ? count / 1000.0f : 1.0f);
+    *width = (int)(WORLD_WIDTH * scale);
+    *height = (int)(WORLD_HEIGHT * scale);
+}
+
+static Vector2 RandomPoint(BenchState *state, int width, int height) {
+    return (Vector2){(float)(BenchRandom(state) % width), (float)(BenchRandom(state) % height)};
+}
+
+// A crowd of count enemies, the pool limit is lifted past MAX_ENEMIES for the large counts
+static void SpawnCrowd(BenchState *state, int count, bool timed) {
+    int width, height;
+    BenchPlayfield(count, &width, &height);
+    InitWorld(&state->world, width, height, 1);
+    World *world = &state->world;
+    if (timed) world->clock = Now;
+    world->enemyPool.maxCapacity = count;
+    world->enemyLimit = count;
+    SpawnEnemies(world, count);
+}
+
+static void SetupWorld(BenchState *state, int count) {
+    SpawnCrowd(state, count, true);
+    World *world = &state->world;
+    state->enemyTemplate = malloc(sizeof(Enemy) * count);
+    memcpy(state->enemyTemplate, world->enemies, sizeof(Enemy) * count);
+    // Keep the player clear of the crowd so no step ends the round
+    world->player.position = (Vector2){-1000.0f, -1000.0f};
+}
+
+static void TeardownWorld(BenchState *state) {
+    UnloadWorld(&state->world);
+    free(state->enemyTemplate);
+}
+
+static double StepPhase(BenchState *state, WorldPhase phase) {
+    World *world = &state->world;
+    memcpy(world->enemies, state->enemyTemplate, sizeof(Enemy) * world->enemyPool.count);
+    world->enemySpawnTimer = -1e30f;
+    world->playerExploded = false;
+    world->particles.count = 0;
+    GameInputs inputs = {0};
+    StepWorld(world, &inputs, WORLD_DT);
+    return world->phaseTime[phase];
+}
+
+static double RunEnemySeek(BenchState *state, int count) { (void)count; return StepPhase(state, PHASE_ENEMIES); }
+static double RunEnemyGrid(BenchState *state, int count) { (void)count; return StepPhase(state, PHASE_GRID); }
+
+static void SetupLasers(BenchState *state, int count) {
+    state->lasers = malloc(sizeof(Laser) * count);
+    state->laserTemplate = malloc(sizeof(Laser) * count);
+    int width, height;
+    BenchPlayfield(count, &width, &height);
+    for (int i = 0; i < count; i++) {
+        float angle = (float)(BenchRandom(state) % 3600) * (PI / 1800.0f);
+        state->laserTemplate[i] = (Laser){RandomPoint(state, width, height), {cosf(angle), sinf(angle)}, 10.0f, true};
+    }
+}
+
+static void TeardownLasers(BenchState *state) {
+    free(state->lasers);
+    free(state->laserTemplate);
+}
+
+static double RunLaserAdvance(BenchState *state, int count) {
+    int width, height;
+    BenchPlayfield(count, &width, &height);
+    memcpy(state->lasers, state->laserTemplate, sizeof(Laser) * count);
+    double start = Now();
+    AdvanceLasers(state->lasers, count, WORLD_DT * 60.0f, width, height);
+    return Now() - start;
+}
+
+// count enemies in the grid, count query points at random
+static void SetupGrid(BenchState *state, int count) {
+    int width, height;
+    BenchPlayfield(count, &width, &height);
+    InitSpatialHash(&state->grid);
+    ResizeSpatialHash(&state->grid, width, height, 2.0f * ENEMY_RADIUS);
+    BeginSpatialHash(&state->grid);
+    for (int i = 0; i < count; i++) InsertSpatialHash(&state->grid, i, RandomPoint(state, width, height));
+    EndSpatialHash(&state->grid);
+    state->points = malloc(sizeof(Vector2) * count);
+    for (int i = 0; i < count; i++) state->points[i] = RandomPoint(state, width, height);
+}
+
+static void TeardownGrid(BenchState *state) {
+    UnloadSpatialHash(&state->grid);
+    free(state->points);
+}
+
+// Every laser against the crowd, as QueryLaserRange does it
+static double RunLaserSweep(BenchState *state, int count) {
+    int ids[8];
+    int hits = 0;
+    double start = Now();
+    for (int i = 0; i < count; i++) hits += QuerySpatialHashBuffer(&state->grid, state->points[i], ENEMY_RADIUS, ids, 8, NULL);
+    double elapsed = Now() - start;
+    if (hits < 0) printf("unreachable\n");    // Keeps the loop from being optimized out
+    return elapsed;
+}
+
+// One player against a crowd of count, per entity cost shows how little of it is visited
+static double RunPlayerCheck(BenchState *state, int count) {
+    const int checks = 1000;
+    const int *ids;
+    int hits = 0;
+    double start = Now();
+    for (int i = 0; i < checks; i++) hits += QuerySpatialHash(&state->grid, state->points[i % count], SHIP_SIZE / 2 + ENEMY_RADIUS, &ids);
+    double elapsed = Now() - start;
+    if (hits < 0) printf("unreachable\n");
+    return elapsed / checks;
+}
+
+static void SetupParticles(BenchState *state, int count) {
+    InitParticles(&state->particles, count);
+    int width, height;
+    BenchPlayfield(count, &width, &height);
+    for (int i = 0; i < count; i++) {
+        float angle = (float)(BenchRandom(state) % 3600) * (PI / 1800.0f);
+        SpawnParticle(&state->particles, RandomPoint(state, width, height), (Vector2){cosf(angle), sinf(angle)}, WHITE);
+    }
+}
+
+static void TeardownParticles(BenchState *state) {
+    UnloadParticles(&state->particles);
+}
+
+// No decay, so every particle survives and the next repetition sees the same count
+static double RunParticleIntegrate(BenchState *state, int count) {
+    (void)count;
+    double start = Now();
+    UpdateParticles(&state->particles, WORLD_DT * 60.0f, 0.0f);
+    return Now() - start;
+}
+
+static void SetupSpawn(BenchState *state, int count) {
+    SpawnCrowd(state, count, false);
+}
+
+// One despawn at a random entry and one spawn in a crowd of count, both should cost the same
+// whatever the crowd size
+static double RunSpawnDespawn(BenchState *state, int count) {
+    World *world = &state->world;
+    int index = (int)(BenchRandom(state) % count);
+    double start = Now();
+    DespawnEnemy(world, index);
+    SpawnEnemies(world, 1);
+    return Now() - start;
+}
+
+static void TeardownSpawn(BenchState *state) {
+    UnloadWorld(&state->world);
+}
+
+static void SetupTouch(BenchState *state, int count) {
+    (void)count;
+    InitInput(&state->input);
+    state->input.joystickCenter = (Vector2){100.0f, 100.0f};
+    state->input.joystickRadius = 50.0f;
+    state->input.fireCenter = (Vector2){500.0f, 100.0f};
+    state->input.fireRadius = 50.0f;
+    touchScript.count = 0;
+}
+
+// count touch points through the map, BENCH_TOUCHES per poll; each poll one finger lifts and
+// a new one lands, the rest move
+static double RunTouchMatch(BenchState *state, int count) {
+    InputState *input = &state->input;
+    int polls = (count + BENCH_TOUCHES - 1) / BENCH_TOUCHES;
+    double start = Now();
+    for (int p = 0; p < polls; p++) {
+        if (touchScript.count == BENCH_TOUCHES) {
+            int lift = (int)(BenchRandom(state) % BENCH_TOUCHES);
+            touchScript.ids[lift] = touchScript.ids[--touchScript.count];
+        }
+        while (touchScript.count < BENCH_TOUCHES) {
+            touchScript.ids[touchScript.count] = (int)(BenchRandom(state) & 0xffff);
+            for (int k = 0; k < touchScript.count; k++) {
+                if (touchScript.ids[k] == touchScript.ids[touchScript.count]) touchScript.ids[touchScript.count]++;
+            }
+            touchScript.positions[touchScript.count] = (Vector2){(float)(BenchRandom(state) % 640), (float)(BenchRandom(state) % 200)};
+            touchScript.count++;
+        }
+        PollInput(input, p);
+        input->count = 0;       // Drop queued fire presses, nothing takes them here
+    }
+    return Now() - start;
+}
+
+#if defined(FASTMATH_COUNT)
+FastMathCounts fastMathCounts;
+
+// The ship turning and firing into a crowd of count: each step moves the ship, advances its
+// lasers and blows up what they hit, so every trig user of a step runs. Reports libm trig
+// calls per step now, and what the same step called before fastmath.h and the cached
+// direction vectors: the calls the helpers stand in for, plus a sinf/cosf pair per laser
+// in flight and per laser fired, which lasers then took from their rotation every step.
+static double RunTrigCalls(BenchState *state, int count) {
+    (void)count;
+    World *world = &state->world;
+    world->playerExploded = false;
+    bool fires = world->laserPool.count < world->laserPool.maxCapacity;     // Fire is held every step
+    int lasers = world->laserPool.count + fires;
+    GameInputs inputs = {.left = true, .fire = true};
+    double start = Now();
+    StepWorld(world, &inputs, WORLD_DT);
+    double elapsed = Now() - start;
+    state->steps++;
+    state->cachedTrig += 2 * lasers + (fires ? 2 : 0);
+    snprintf(state->details, sizeof(state->details), "\"libm_trig_per_step\": %.2f, \"libm_trig_per_step_before\": %.2f",
+             (double)fastMathCounts.libm / state->steps,
+             (double)(fastMathCounts.libm + fastMathCounts.fast + state->cachedTrig) / state->steps);
+    return elapsed;
+}
+
+static void SetupTrigCalls(BenchState *state, int count) {
+    SpawnCrowd(state, count, false);
+    state->world.player.position = (Vector2){state->world.width * 0.5f, state->world.height * 0.5f};
+    // Half a second of play first, so lasers are in flight and the counts are steady state
+    for (int t = 0; t < WORLD_TICK_RATE / 2; t++) RunTrigCalls(state, count);
+    fastMathCounts = (FastMathCounts){0};
+    state->steps = 0;
+    state->cachedTrig = 0;
+}
+#endif
+
+static void TeardownNothing(BenchState *state) {
+    (void)state;
+}
+
+typedef struct {
+    const char *name;
+    const char *entity;         // What count counts
+    void (*setup)(BenchState *state, int count);
+    double (*run)(BenchState *state, int count);      // Seconds for one repetition over count entities
+    void (*teardown)(BenchState *state);
+} Scenario;
+
+static const Scenario scenarios[] = {
+    {"laser_advance", "lasers", SetupLasers, RunLaserAdvance, TeardownLasers},
+    {"enemy_seek", "enemies", SetupWorld, RunEnemySeek, TeardownWorld},
+    {"enemy_grid", "enemies", SetupWorld, RunEnemyGrid, TeardownWorld},
+    {"laser_sweep", "lasers vs as many enemies", SetupGrid, RunLaserSweep, TeardownGrid},
+    {"player_check", "enemies around one player", SetupGrid, RunPlayerCheck, TeardownGrid},
+    {"particle_integrate", "particles", SetupParticles, RunParticleIntegrate, TeardownParticles},
+    {"spawn_despawn", "enemies in the crowd", SetupSpawn, RunSpawnDespawn, TeardownSpawn},
+    {"touch_match", "touch points", SetupTouch, RunTouchMatch, TeardownNothing},
+#if defined(FASTMATH_COUNT)
+    {"trig_calls", "enemies", SetupTrigCalls, RunTrigCalls, TeardownSpawn},
+#endif
+};
+
+static int CompareDouble(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char **argv) {
+    int maxCount = 1000000;
+    const char *only = NULL;
+    double minTime = 0.2;
+    int threadCount = 0;            // Single threaded by default, the wasm build has no threads
+    const char *outPath = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) maxCount = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-k") && i + 1 < argc) only = argv[++i];
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc) minTime = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-j") && i + 1 < argc) threadCount = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-o") && i + 1 < argc) outPath = argv[++i];
+        else {
+            fprintf(stderr, "usage: %s [-n maxCount] [-k scenario] [-t seconds] [-j threads] [-o bench.json]\n", argv[0]);
+            return 1;
+        }
+    }
+    FILE *out = outPath ? fopen(outPath, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "cannot write %s\n", outPath);
+        return 1;
+    }
+    if (threadCount > 0) InitJobs(threadCount - 1);
+
+    fprintf(out, "{\n  \"target\": \"%s\",\n  \"simd\": \"%s\",\n  \"threads\": %d,\n  \"results\": [", BENCH_TARGET,
+            ParticleKernelName(), GetJobWorkerCount() + 1);
+    bool first = true;
+    for (size_t s = 0; s < sizeof(scenarios) / sizeof(scenarios[0]); s++) {
+        const Scenario *scenario = &scenarios[s];
+        if (only && strcmp(only, scenario->name) != 0) continue;
+
+        for (int count = 100; count <= maxCount; count *= 10) {
+            BenchState state;
+            memset(&state, 0, sizeof(state));
+            state.rng = 0x9e3779b9u;
+            scenario->setup(&state, count);
+
+            // One warm-up, then repeat until minTime has passed; the median is reported
+            scenario->run(&state, count);
+            double samples[1000];
+            int reps = 0;
+            double spent = 0.0;
+            while (reps < 1000 && (reps < 5 || spent < minTime)) {
+                double start = Now();
+                samples[reps++] = scenario->run(&state, count);
+                spent += Now() - start;
+            }
+            scenario->teardown(&state);
+
+            qsort(samples, reps, sizeof(double), CompareDouble);
+            double median = samples[reps / 2];
+            fprintf(out, "%s\n    {\"scenario\": \"%s\", \"entity\": \"%s\", \"count\": %d, \"repetitions\": %d, "
+                         "\"ns_per_entity\": %.3f, \"entities_per_s\": %.0f%s%s}",
+                    first ? "" : ",", scenario->name, scenario->entity, count, reps,
+                    median / count * 1e9, (median > 0.0) ? count / median : 0.0,
+                    state.details[0] ? ", " : "", state.details);
+            fprintf(stderr, "%-18s %8d  %9.3f ns/entity%s%s\n", scenario->name, count, median / count * 1e9,
+                    state.details[0] ? "  " : "", state.details);
+            first = false;
+        }
+    }
+    fprintf(out, "\n  ]\n}\n");
+
+    if (out != stdout) fclose(out);
+    CloseJobs();
+    return 0;
+}
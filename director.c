@@ -0,0 +1,222 @@
+#include "director.h"
+#include "fastmath.h"
+#include <string.h>
+#include <math.h>
+
+// Same xorshift as WorldRandom, on the world's state
+static int DirectorRandom(unsigned int *state) {
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return (int)(x >> 1);
+}
+
+// [0, 1) in steps of 1/65536
+static float DirectorRandomUnit(unsigned int *state) {
+    return (DirectorRandom(state) & 0xffff) * (1.0f / 65536.0f);
+}
+
+static Vector2 ClampToField(const WaveDirector *director, Vector2 spot) {
+    spot.x = fminf(fmaxf(spot.x, 0.0f), (float)director->width);
+    spot.y = fminf(fmaxf(spot.y, 0.0f), (float)director->height);
+    return spot;
+}
+
+// Push a spot closer than radius to the player out to that distance, straight away from
+// the player. If the playfield edge is in the way, the opposite side faces into the field.
+static Vector2 KeepClear(const WaveDirector *director, Vector2 player, Vector2 spot, float radius) {
+    spot = ClampToField(director, spot);
+    float dx = spot.x - player.x, dy = spot.y - player.y;
+    float distance = sqrtf(dx * dx + dy * dy);
+    if (distance >= radius) return spot;
+    if (distance < 1e-3f) {
+        dx = (player.x < director->width * 0.5f) ? 1.0f : -1.0f;
+        dy = 0.0f;
+        distance = 1.0f;
+    }
+    float scale = radius / distance;
+    Vector2 out = ClampToField(director, (Vector2){player.x + dx * scale, player.y + dy * scale});
+    float ox = out.x - player.x, oy = out.y - player.y;
+    if (ox * ox + oy * oy >= radius * radius * 0.999f) return out;
+    return ClampToField(director, (Vector2){player.x - dx * scale, player.y - dy * scale});
+}
+
+void InitWaveDirector(WaveDirector *director, int width, int height) {
+    memset(director, 0, sizeof(*director));
+    director->width = width;
+    director->height = height;
+    director->safeRadius = DIRECTOR_SAFE_RADIUS;
+    director->budget = DIRECTOR_TICK_BUDGET;
+    ClearWaveDirector(director);
+}
+
+void ClearWaveDirector(WaveDirector *director) {
+    for (int s = 0; s < DIRECTOR_WHEEL_SLOTS; s++) director->slotHead[s] = director->slotTail[s] = -1;
+    for (int i = 0; i < DIRECTOR_MAX_ORDERS; i++) director->orders[i].next = (i + 1 < DIRECTOR_MAX_ORDERS) ? i + 1 : -1;
+    director->freeHead = 0;
+    director->dueHead = director->dueTail = -1;
+    director->pending = 0;
+}
+
+bool ScheduleSpawnWave(WaveDirector *director, int delayTicks, SpawnPattern pattern, int count) {
+    if (count <= 0 || director->freeHead < 0) return false;
+    if (delayTicks < 0) delayTicks = 0;
+    int index = director->freeHead;
+    SpawnOrder *order = &director->orders[index];
+    director->freeHead = order->next;
+
+    *order = (SpawnOrder){.pattern = pattern, .count = count, .perTick = count, .next = -1};
+    if (pattern == SPAWN_STREAM) order->perTick = (count + DIRECTOR_STREAM_TICKS - 1) / DIRECTOR_STREAM_TICKS;
+    order->rounds = delayTicks / DIRECTOR_WHEEL_SLOTS;
+    int slot = (director->tick + delayTicks) & (DIRECTOR_WHEEL_SLOTS - 1);
+
+    // Append, so orders for the same tick come due in the order they were made
+    if (director->slotTail[slot] < 0) director->slotHead[slot] = index;
+    else director->orders[director->slotTail[slot]].next = index;
+    director->slotTail[slot] = index;
+    director->waves++;
+    director->pending += count;
+    return true;
+}
+
+static void FreeOrder(WaveDirector *director, int index) {
+    director->pending -= director->orders[index].count - director->orders[index].spawned;
+    director->orders[index].next = director->freeHead;
+    director->freeHead = index;
+}
+
+void CancelDueSpawns(WaveDirector *director) {
+    while (director->dueHead >= 0) {
+        int index = director->dueHead;
+        director->dueHead = director->orders[index].next;
+        FreeOrder(director, index);
+    }
+    director->dueTail = -1;
+}
+
+// Fix the pattern's anchor when the order comes due, so it forms around the player as it is now
+static void StartOrder(WaveDirector *director, SpawnOrder *order, Vector2 player, unsigned int *rng) {
+    switch (order->pattern) {
+        case SPAWN_RING:
+            order->center = player;
+            order->angle = DirectorRandomUnit(rng) * 2.0f * PI;
+            break;
+        case SPAWN_BURST: {
+            // Center far enough out that the whole cluster clears the safe radius
+            Vector2 center = {DirectorRandomUnit(rng) * director->width, DirectorRandomUnit(rng) * director->height};
+            order->center = KeepClear(director, player, center, director->safeRadius + DIRECTOR_BURST_RADIUS);
+            break;
+        }
+        case SPAWN_STREAM:
+            order->edge = DirectorRandom(rng) & 3;
+            break;
+        default:
+            break;
+    }
+}
+
+static Vector2 PlaceSpawn(const WaveDirector *director, const SpawnOrder *order, Vector2 player, unsigned int *rng) {
+    Vector2 spot;
+    switch (order->pattern) {
+        case SPAWN_RING: {
+            // Concentric rings DIRECTOR_RING_SPACING apart, each filled with neighbours that far
+            // apart before the next one out starts; the last ring spreads its share evenly
+            float radius = director->safeRadius * 1.5f;
+            int index = order->spawned, first = 0;
+            int slots = (int)(2.0f * PI * radius / DIRECTOR_RING_SPACING);
+            while (index >= first + slots) {
+                first += slots;
+                radius += DIRECTOR_RING_SPACING;
+                slots = (int)(2.0f * PI * radius / DIRECTOR_RING_SPACING);
+            }
+            int onRing = (order->count - first < slots) ? order->count - first : slots;
+            float angle = order->angle + (index - first) * (2.0f * PI / onRing);
+            float s, c;
+            FastSinCos(angle, &s, &c);
+            spot = (Vector2){order->center.x + c * radius, order->center.y + s * radius};
+            break;
+        }
+        case SPAWN_BURST: {
+            float angle = DirectorRandomUnit(rng) * 2.0f * PI;
+            float radius = sqrtf(DirectorRandomUnit(rng)) * DIRECTOR_BURST_RADIUS;
+            float s, c;
+            FastSinCos(angle, &s, &c);
+            spot = (Vector2){order->center.x + c * radius, order->center.y + s * radius};
+            break;
+        }
+        case SPAWN_STREAM: {
+            float along = DirectorRandomUnit(rng);
+            int edge = order->edge;
+            if (edge == 0) spot = (Vector2){along * director->width, 0.0f};
+            else if (edge == 1) spot = (Vector2){(float)director->width, along * director->height};
+            else if (edge == 2) spot = (Vector2){along * director->width, (float)director->height};
+            else spot = (Vector2){0.0f, along * director->height};
+            break;
+        }
+        default:
+            return PickSpawnSpot(director, player, rng);
+    }
+    return KeepClear(director, player, spot, director->safeRadius);
+}
+
+Vector2 PickSpawnSpot(const WaveDirector *director, Vector2 player, unsigned int *rng) {
+    Vector2 spot = {(float)(DirectorRandom(rng) % director->width), (float)(DirectorRandom(rng) % director->height)};
+    return KeepClear(director, player, spot, director->safeRadius);
+}
+
+int AdvanceWaveDirector(WaveDirector *director, Vector2 player, unsigned int *rng, Vector2 *spots, int max) {
+    // Orders in this slot with no turns left come due, the rest wait another turn
+    int slot = director->tick;
+    director->tick = (director->tick + 1) & (DIRECTOR_WHEEL_SLOTS - 1);
+    int index = director->slotHead[slot];
+    director->slotHead[slot] = director->slotTail[slot] = -1;
+    while (index >= 0) {
+        SpawnOrder *order = &director->orders[index];
+        int next = order->next;
+        order->next = -1;
+        if (order->rounds > 0) {
+            order->rounds--;
+            if (director->slotTail[slot] < 0) director->slotHead[slot] = index;
+            else director->orders[director->slotTail[slot]].next = index;
+            director->slotTail[slot] = index;
+        } else {
+            StartOrder(director, order, player, rng);
+            if (director->dueTail < 0) director->dueHead = index;
+            else director->orders[director->dueTail].next = index;
+            director->dueTail = index;
+        }
+        index = next;
+    }
+
+    // Work the due list off oldest first until the tick's budget is spent
+    int budget = (director->budget < max) ? director->budget : max;
+    int placed = 0;
+    int previous = -1;
+    index = director->dueHead;
+    while (index >= 0 && placed < budget) {
+        SpawnOrder *order = &director->orders[index];
+        int next = order->next;
+        int take = order->count - order->spawned;
+        if (take > order->perTick) take = order->perTick;
+        if (take > budget - placed) take = budget - placed;
+        for (int k = 0; k < take; k++) {
+            spots[placed++] = PlaceSpawn(director, order, player, rng);
+            order->spawned++;
+        }
+        director->pending -= take;
+
+        if (order->spawned == order->count) {
+            if (previous < 0) director->dueHead = next;
+            else director->orders[previous].next = next;
+            if (director->dueTail == index) director->dueTail = previous;
+            order->next = director->freeHead;
+            director->freeHead = index;
+        } else {
+            previous = index;
+        }
+        index = next;
+    }
+    return placed;
+}
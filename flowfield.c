@@ -0,0 +1,177 @@
+#include "flowfield.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+static const int neighbourX[8] = {1, -1, 0, 0, 1, 1, -1, -1};
+static const int neighbourY[8] = {0, 0, 1, -1, 1, -1, 1, -1};
+
+void InitFlowField(FlowField *field, int width, int height, float cellSize) {
+    memset(field, 0, sizeof(*field));
+    field->cellSize = cellSize;
+    field->invCellSize = 1.0f / cellSize;
+    field->cols = (int)ceilf(width / cellSize);
+    field->rows = (int)ceilf(height / cellSize);
+    int cells = field->cols * field->rows;
+    field->blocked = calloc(cells, 1);
+    field->distance = malloc(sizeof(int) * cells);
+    field->direction = calloc(cells, sizeof(Vector2));
+    field->heap = malloc(sizeof(long long) * cells * 8);   // A cell is pushed at most once per neighbour
+    field->goal = -1;
+}
+
+void UnloadFlowField(FlowField *field) {
+    free(field->blocked);
+    free(field->distance);
+    free(field->direction);
+    free(field->heap);
+    memset(field, 0, sizeof(*field));
+}
+
+static int CellIndex(const FlowField *field, float x, float y) {
+    int cx = (int)floorf(x * field->invCellSize);
+    int cy = (int)floorf(y * field->invCellSize);
+    cx = (cx < 0) ? 0 : (cx >= field->cols) ? field->cols - 1 : cx;
+    cy = (cy < 0) ? 0 : (cy >= field->rows) ? field->rows - 1 : cy;
+    return cy * field->cols + cx;
+}
+
+int GetFlowFieldCell(const FlowField *field, Vector2 position) {
+    return CellIndex(field, position.x, position.y);
+}
+
+void SetFlowFieldObstacle(FlowField *field, Rectangle area, bool blocked) {
+    int first = CellIndex(field, area.x, area.y);
+    int last = CellIndex(field, area.x + area.width, area.y + area.height);
+    for (int y = first / field->cols; y <= last / field->cols; y++) {
+        for (int x = first % field->cols; x <= last % field->cols; x++) {
+            unsigned char *cell = &field->blocked[y * field->cols + x];
+            field->blockedCount += (int)blocked - (int)*cell;
+            *cell = blocked;
+        }
+    }
+    field->dirty = true;
+}
+
+void ClearFlowFieldObstacles(FlowField *field) {
+    memset(field->blocked, 0, field->cols * field->rows);
+    field->blockedCount = 0;
+    field->dirty = true;
+}
+
+// Binary min-heap of (distance << 32 | cell); stale entries are skipped when popped
+static void HeapPush(FlowField *field, int *count, int cell) {
+    long long *heap = field->heap;
+    long long entry = ((long long)field->distance[cell] << 32) | cell;
+    int i = (*count)++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (heap[parent] <= entry) break;
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i] = entry;
+}
+
+static long long HeapPop(FlowField *field, int *count) {
+    long long *heap = field->heap;
+    long long top = heap[0];
+    long long last = heap[--(*count)];
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= *count) break;
+        if (child + 1 < *count && heap[child + 1] < heap[child]) child++;
+        if (last <= heap[child]) break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = last;
+    return top;
+}
+
+// Diagonal moves may not cut the corner of a blocked cell
+static bool CanStep(const FlowField *field, int x, int y, int k) {
+    int nx = x + neighbourX[k], ny = y + neighbourY[k];
+    if (nx < 0 || ny < 0 || nx >= field->cols || ny >= field->rows) return false;
+    if (field->blocked[ny * field->cols + nx]) return false;
+    if (k >= 4 && (field->blocked[y * field->cols + nx] || field->blocked[ny * field->cols + x])) return false;
+    return true;
+}
+
+static void BuildDistances(FlowField *field) {
+    int cells = field->cols * field->rows;
+    for (int i = 0; i < cells; i++) field->distance[i] = FLOW_UNREACHABLE;
+    if (field->blocked[field->goal]) return;
+
+    int count = 0;
+    field->distance[field->goal] = 0;
+    HeapPush(field, &count, field->goal);
+    while (count > 0) {
+        long long entry = HeapPop(field, &count);
+        int cell = (int)(entry & 0xffffffff);
+        if ((int)(entry >> 32) != field->distance[cell]) continue;     // Improved since it was pushed
+        int x = cell % field->cols, y = cell / field->cols;
+        for (int k = 0; k < 8; k++) {
+            if (!CanStep(field, x, y, k)) continue;
+            int next = cell + neighbourY[k] * field->cols + neighbourX[k];
+            int cost = field->distance[cell] + ((k < 4) ? FLOW_STRAIGHT_COST : FLOW_DIAGONAL_COST);
+            if (cost < field->distance[next]) {
+                field->distance[next] = cost;
+                HeapPush(field, &count, next);
+            }
+        }
+    }
+}
+
+// Direction is the distance gradient over the open neighbours, which bends smoothly instead
+// of snapping to eight headings. Where that cancels out, step to the cheapest neighbour.
+static void BuildDirections(FlowField *field) {
+    static const float inverseLength[8] = {1, 1, 1, 1, 0.70710678f, 0.70710678f, 0.70710678f, 0.70710678f};
+    for (int y = 0; y < field->rows; y++) {
+        for (int x = 0; x < field->cols; x++) {
+            int cell = y * field->cols + x;
+            int own = field->distance[cell];
+            Vector2 dir = {0.0f, 0.0f};
+            if (own != FLOW_UNREACHABLE && own != 0) {
+                int best = -1;
+                int bestDistance = own;
+                for (int k = 0; k < 8; k++) {
+                    if (!CanStep(field, x, y, k)) continue;
+                    int next = field->distance[cell + neighbourY[k] * field->cols + neighbourX[k]];
+                    if (next == FLOW_UNREACHABLE) continue;
+                    float drop = (float)(own - next) * inverseLength[k];
+                    dir.x += neighbourX[k] * inverseLength[k] * drop;
+                    dir.y += neighbourY[k] * inverseLength[k] * drop;
+                    if (next < bestDistance) {
+                        bestDistance = next;
+                        best = k;
+                    }
+                }
+                float length = sqrtf(dir.x * dir.x + dir.y * dir.y);
+                if (length > 1e-3f) {
+                    dir.x /= length;
+                    dir.y /= length;
+                } else if (best >= 0) {
+                    dir = (Vector2){neighbourX[best] * inverseLength[best], neighbourY[best] * inverseLength[best]};
+                }
+            }
+            field->direction[cell] = dir;
+        }
+    }
+}
+
+bool UpdateFlowField(FlowField *field, Vector2 goal) {
+    int cell = GetFlowFieldCell(field, goal);
+    if (cell == field->goal && !field->dirty) return false;
+    field->goal = cell;
+    field->dirty = false;
+    BuildDistances(field);
+    BuildDirections(field);
+    field->rebuilds++;
+    return true;
+}
+
+Vector2 SampleFlowField(const FlowField *field, Vector2 position) {
+    return field->direction[GetFlowFieldCell(field, position)];
+}
@@ -0,0 +1,860 @@
+// Headless batch runner: steps many independent worlds on all cores, no window needed.
+// Usage: headless [-w worlds] [-t ticks] [-j threads] [-s seed] [-e enemies] [-o stats.csv]
+//        headless -R session.rec [-t ticks] [-s seed] [-e enemies]
+//                                                          record one bot session
+//        headless -r session.rec                           replay it, prints a state checksum
+//        headless -p a.rec [-p b.rec ...] [-n repeats] [-o perf.csv]
+//                                                          per-phase step timing percentiles
+//        headless -c [-t ticks] [-s seed] [-e enemies]     snapshot and rewind self-check, history memory cost
+//        headless -g [-n layouts] [-s seed]                spatial hash queries against a brute-force scan
+//        headless -H [-n operations] [-s seed]             entity handles through spawns, despawns and slot reuse
+//        headless -v out [-r session.rec | -t ticks -s seed -e enemies] [-W width] [-f ticks]
+//                                                          render frames offline: out.rgba or - (raw RGBA
+//                                                          stream) or a printf pattern like f%06d.png
+// -e enemies allows that many enemies at once, each spawn wave fills up.
+#define _POSIX_C_SOURCE 200809L  // clock_gettime
+#include "world.h"
+#include "jobs.h"
+#include "replay.h"
+#include "snapshot.h"
+#include "raster.h"
+#include "fastmath.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+
+// Per-world results collected while soaking
+typedef struct {
+    unsigned int seed;
+    int deaths;         // Times the player exploded
+    int kills;          // Enemies destroyed over all rounds
+    int bestScore;      // Highest score reached in one round
+} WorldStats;
+
+typedef struct {
+    World *worlds;
+    WorldStats *stats;
+    int begin;
+    int end;
+    int ticks;
+} Worker;
+
+static unsigned int BotRandom(unsigned int *state) {
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+// Simple bot: turn towards the closest enemy, fire when roughly aimed, restart when dead
+static void BotInputs(const World *world, unsigned int *botRng, GameInputs *inputs) {
+    memset(inputs, 0, sizeof(*inputs));
+    if (world->playerExploded) {
+        inputs->restart = (BotRandom(botRng) % 30) == 0;
+        return;
+    }
+
+    const Spaceship *player = &world->player;
+    float bestDist = -1.0f;
+    Vector2 target = {0};
+    for (int i = 0; i < world->enemyPool.count; i++) {
+        if (!world->enemies[i].active) continue;
+        float dx = world->enemies[i].position.x - player->position.x;
+        float dy = world->enemies[i].position.y - player->position.y;
+        float dist = dx * dx + dy * dy;
+        if (bestDist < 0 || dist < bestDist) {
+            bestDist = dist;
+            target = (Vector2){dx, dy};
+        }
+    }
+
+    if (bestDist < 0) {
+        // Nothing to shoot, wander
+        unsigned int r = BotRandom(botRng);
+        inputs->left = (r & 3) == 0;
+        inputs->right = (r & 3) == 1;
+        inputs->up = (r & 4) != 0;
+        return;
+    }
+
+    float targetRotation = atan2f(target.y, target.x) * RAD2DEG;
+    float diff = fmodf(targetRotation - player->rotation, 360.0f);
+    if (diff > 180.0f) diff -= 360.0f;
+    if (diff < -180.0f) diff += 360.0f;
+    inputs->right = diff > 2.5f;
+    inputs->left = diff < -2.5f;
+    inputs->down = bestDist < 150.0f * 150.0f;
+    inputs->up = !inputs->down && (BotRandom(botRng) % 4) == 0;
+    inputs->fire = fabsf(diff) < 10.0f && (BotRandom(botRng) % 6) == 0;
+}
+
+static void *RunWorker(void *arg) {
+    Worker *worker = (Worker *)arg;
+    for (int w = worker->begin; w < worker->end; w++) {
+        World *world = &worker->worlds[w];
+        WorldStats *stats = &worker->stats[w];
+        unsigned int botRng = stats->seed * 2654435761u + 1;
+        GameInputs inputs;
+        for (int t = 0; t < worker->ticks; t++) {
+            BotInputs(world, &botRng, &inputs);
+            int score = world->score;
+            bool exploded = world->playerExploded;
+            StepWorld(world, &inputs, WORLD_DT);
+            if (world->score > score) stats->kills += world->score - score;
+            if (world->score > stats->bestScore) stats->bestScore = world->score;
+            if (!exploded && world->playerExploded) stats->deaths++;
+        }
+    }
+    return NULL;
+}
+
+static double Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// FNV-1a over the gameplay state, equal checksums mean a replay matched its recording
+static unsigned int WorldChecksum(const World *world) {
+    unsigned int hash = 2166136261u;
+    #define MIX(value) do { unsigned char bytes[sizeof(value)]; memcpy(bytes, &(value), sizeof(value)); \
+        for (size_t b = 0; b < sizeof(value); b++) hash = (hash ^ bytes[b]) * 16777619u; } while (0)
+    MIX(world->player.position);
+    MIX(world->player.rotation);
+    MIX(world->player.speed);
+    for (int i = 0; i < world->laserPool.count; i++) {
+        if (world->lasers[i].active) MIX(world->lasers[i].position);
+    }
+    for (int i = 0; i < world->enemyPool.count; i++) {
+        if (world->enemies[i].active) MIX(world->enemies[i].position);
+    }
+    MIX(world->score);
+    MIX(world->rng);
+    MIX(world->particles.count);
+    #undef MIX
+    return hash;
+}
+
+// Horde mode: up to enemies alive, every spawn wave tops the crowd up
+static void SetEnemyHorde(World *world, int enemies) {
+    if (enemies <= 0) return;
+    world->enemyLimit = enemies;
+    world->enemyWave = enemies;
+}
+
+static int RecordSession(const char *path, unsigned int seed, int ticks, int enemies) {
+    World world;
+    InputRecording rec;
+    InitWorld(&world, WORLD_WIDTH, WORLD_HEIGHT, seed);
+    SetEnemyHorde(&world, enemies);
+    BeginRecording(&rec, &world, seed);
+    unsigned int botRng = seed * 2654435761u + 1;
+    GameInputs inputs;
+    for (int t = 0; t < ticks; t++) {
+        BotInputs(&world, &botRng, &inputs);
+        RecordTick(&rec, &inputs);
+        StepWorld(&world, &inputs, WORLD_DT);
+    }
+
+    bool saved = SaveRecording(&rec, path);
+    if (saved) printf("%s: seed %u, %d ticks, %d bytes, checksum %08x\n", path, seed, rec.ticks, rec.size, WorldChecksum(&world));
+    else fprintf(stderr, "cannot write %s\n", path);
+    UnloadRecording(&rec);
+    UnloadWorld(&world);
+    return saved ? 0 : 1;
+}
+
+// Step a fresh world through a whole recording; world->clock may be set by the caller
+static void ReplaySession(World *world, InputRecording *rec, double *phaseSamples) {
+    GameInputs inputs;
+    RewindRecording(rec);
+    for (int t = 0; ReadRecordedTick(rec, &inputs); t++) {
+        StepWorld(world, &inputs, WORLD_DT);
+        if (phaseSamples) memcpy(phaseSamples + (size_t)t * WORLD_PHASE_COUNT, world->phaseTime, sizeof(world->phaseTime));
+    }
+}
+
+static int ReplayFile(const char *path) {
+    InputRecording rec;
+    if (!LoadRecording(&rec, path)) {
+        fprintf(stderr, "cannot read %s\n", path);
+        return 1;
+    }
+    World world;
+    InitRecordedWorld(&world, &rec);
+    ReplaySession(&world, &rec, NULL);
+    printf("%s: seed %u, %d ticks, score %d, checksum %08x\n", path, rec.seed, rec.ticks, world.score, WorldChecksum(&world));
+    UnloadWorld(&world);
+    UnloadRecording(&rec);
+    return 0;
+}
+
+// One tick of the world at width / WORLD_WIDTH scale: the game's layers in its draw order,
+// without interpolation (every frame is a tick) and without the HUD and touch controls
+static void RenderWorld(Canvas *canvas, const World *world) {
+    float scale = (float)canvas->width / WORLD_WIDTH;
+    ClearCanvas(canvas, BLACK);
+
+    const ParticleSystem *ps = &world->particles;
+    for (int i = 0; i < ps->count; i++) {
+        Color color = ps->color[i];
+        color.a = (unsigned char)(color.a * fminf(fmaxf(ps->alpha[i], 0.0f), 1.0f));
+        BlendCanvasPixel(canvas, (int)floorf(ps->x[i] * scale), (int)floorf(ps->y[i] * scale), color);
+    }
+
+    if (!world->playerExploded) {
+        Vector2 position = world->player.position;
+        Vector2 dir;
+        FastDirection(world->player.rotation, &dir.x, &dir.y);
+        float half = SHIP_SIZE * 0.5f;
+        Vector2 front = {(position.x + SHIP_SIZE * dir.x) * scale, (position.y + SHIP_SIZE * dir.y) * scale};
+        Vector2 backLeft = {(position.x - half * dir.x + half * dir.y) * scale, (position.y - half * dir.y - half * dir.x) * scale};
+        Vector2 backRight = {(position.x - half * dir.x - half * dir.y) * scale, (position.y - half * dir.y + half * dir.x) * scale};
+        FillCanvasTriangle(canvas, front, backLeft, backRight, WHITE);
+    }
+
+    for (int i = 0; i < world->laserPool.count; i++) {
+        const Laser *laser = &world->lasers[i];
+        if (!laser->active) continue;
+        Vector2 start = {laser->position.x * scale, laser->position.y * scale};
+        Vector2 end = {(laser->position.x + LASER_LENGTH * laser->direction.x) * scale,
+                       (laser->position.y + LASER_LENGTH * laser->direction.y) * scale};
+        DrawCanvasLine(canvas, start, end, YELLOW);
+    }
+
+    for (int i = 0; i < world->enemyPool.count; i++) {
+        const Enemy *enemy = &world->enemies[i];
+        if (!enemy->active) continue;
+        Vector2 center = {enemy->position.x * scale, enemy->position.y * scale};
+        FillCanvasCircle(canvas, center, ENEMY_RADIUS * scale, RED);
+    }
+}
+
+// Step a recording, or the bot from seed, and render every frameTicks-th tick as fast as
+// the machine goes. Output is a raw RGBA stream (a file, or - for stdout to pipe into an
+// encoder) unless the path holds a printf pattern, which numbers one PNG per frame.
+// A frame name pattern holds exactly one integer conversion (%d, %05d, %-3i and the like)
+// and no other %, so handing it to snprintf with the frame number is safe
+static bool IsFramePattern(const char *path) {
+    int conversions = 0;
+    for (const char *c = strchr(path, '%'); c; c = strchr(c, '%')) {
+        c++;
+        while (*c == '0' || *c == '-') c++;
+        while (*c >= '0' && *c <= '9') c++;
+        if ((*c != 'd' && *c != 'i') || ++conversions > 1) return false;
+    }
+    return conversions == 1;
+}
+
+static int RenderSession(const char *outPath, const char *replayPath, unsigned int seed, int ticks, int enemies,
+                         int width, int frameTicks) {
+    InputRecording rec;
+    World world;
+    if (replayPath) {
+        if (!LoadRecording(&rec, replayPath)) {
+            fprintf(stderr, "cannot read %s\n", replayPath);
+            return 1;
+        }
+        InitRecordedWorld(&world, &rec);
+        RewindRecording(&rec);
+        ticks = rec.ticks;
+    } else {
+        InitWorld(&world, WORLD_WIDTH, WORLD_HEIGHT, seed);
+        SetEnemyHorde(&world, enemies);
+    }
+
+    // Anything else is one raw stream, a % in its name included; a .png name must be a pattern
+    bool pngs = IsFramePattern(outPath);
+    size_t pathLength = strlen(outPath);
+    if (!pngs && pathLength >= 4 && !strcmp(outPath + pathLength - 4, ".png")) {
+        fprintf(stderr, "%s: frame names need exactly one integer conversion like %%06d and no other %%\n", outPath);
+        if (replayPath) UnloadRecording(&rec);
+        UnloadWorld(&world);
+        return 1;
+    }
+    FILE *stream = NULL;
+    if (!pngs) {
+        stream = strcmp(outPath, "-") ? fopen(outPath, "wb") : stdout;
+        if (!stream) {
+            fprintf(stderr, "cannot write %s\n", outPath);
+            if (replayPath) UnloadRecording(&rec);
+            UnloadWorld(&world);
+            return 1;
+        }
+    }
+    // Report on stderr when frames go to stdout
+    FILE *report = (stream == stdout) ? stderr : stdout;
+
+    Canvas canvas;
+    int height = (int)((long long)width * WORLD_HEIGHT / WORLD_WIDTH);
+    if (!LoadCanvas(&canvas, width, height)) {
+        fprintf(stderr, "cannot allocate a %dx%d canvas\n", width, height);
+        if (stream && stream != stdout) fclose(stream);
+        if (replayPath) UnloadRecording(&rec);
+        UnloadWorld(&world);
+        return 1;
+    }
+
+    unsigned int botRng = seed * 2654435761u + 1;
+    int frames = 0;
+    bool ok = true;
+    double renderTime = 0.0, writeTime = 0.0;
+    double start = Now();
+    GameInputs inputs;
+    for (int t = 0; t < ticks && ok; t++) {
+        if (replayPath) ReadRecordedTick(&rec, &inputs);
+        else BotInputs(&world, &botRng, &inputs);
+        StepWorld(&world, &inputs, WORLD_DT);
+        if (t % frameTicks != 0) continue;
+
+        double renderStart = Now();
+        RenderWorld(&canvas, &world);
+        double writeStart = Now();
+        if (pngs) {
+            char fileName[1024];
+            snprintf(fileName, sizeof(fileName), outPath, frames);
+            ok = ExportCanvasPNG(&canvas, fileName);
+            if (!ok) fprintf(stderr, "cannot write %s\n", fileName);
+        } else {
+            ok = WriteCanvasRGBA(&canvas, stream);
+            if (!ok) fprintf(stderr, "cannot write %s\n", outPath);
+        }
+        renderTime += writeStart - renderStart;
+        writeTime += Now() - writeStart;
+        frames++;
+    }
+    double elapsed = Now() - start;
+    if (stream && stream != stdout && fclose(stream) != 0) ok = false;
+
+    double fps = (double)WORLD_TICK_RATE / frameTicks;
+    fprintf(report, "%d frames %dx%d from %d ticks: %.3f s, %.1f frames/s, %.1fx real time at %g fps\n",
+            frames, width, height, ticks, elapsed, frames / elapsed, frames / fps / elapsed, fps);
+    fprintf(report, "render %.3f ms/frame, write %.3f ms/frame, checksum %08x\n",
+            renderTime * 1000.0 / (frames ? frames : 1), writeTime * 1000.0 / (frames ? frames : 1), WorldChecksum(&world));
+    if (!pngs && ok) {
+        // Rational rate, exact for any -f
+        fprintf(report, "encode: ffmpeg -f rawvideo -pixel_format rgba -video_size %dx%d -framerate %d/%d -i %s out.mp4\n",
+                width, height, WORLD_TICK_RATE, frameTicks, outPath);
+    }
+
+    UnloadCanvas(&canvas);
+    if (replayPath) UnloadRecording(&rec);
+    UnloadWorld(&world);
+    return ok ? 0 : 1;
+}
+
+// Checkpoint a bot session halfway, finish it, then finish it again from the checkpoint in a
+// fresh world; both must end in the same state. Then rewind a few seconds and compare with
+// the snapshot taken at that tick, and report what the rewind history costs per second.
+static int CheckSnapshots(unsigned int seed, int ticks, int enemies) {
+    const int interval = 4;
+    // Rewind target, 3 s before the last captured tick
+    const int rewindTicks = 3 * WORLD_TICK_RATE / interval * interval;
+    int lastCapture = (ticks - 1) / interval * interval;
+    int target = lastCapture - rewindTicks;
+    if (ticks < 1 || target < 0) {
+        fprintf(stderr, "-c needs at least %d ticks (-t) to rewind %d ticks\n", rewindTicks + 1, rewindTicks);
+        return 1;
+    }
+
+    World world;
+    InitWorld(&world, WORLD_WIDTH, WORLD_HEIGHT, seed);
+    SetEnemyHorde(&world, enemies);
+    RewindBuffer rewind;
+    InitRewind(&rewind, 10.0f, interval);
+    unsigned int botRng = seed * 2654435761u + 1;
+    GameInputs inputs;
+
+    int half = ticks / 2;
+    unsigned char *checkpoint = NULL;
+    int checkpointSize = 0;
+    unsigned int checkpointRng = 0;
+    double saveTime = 0.0;
+
+    unsigned char *expectedFrame = NULL;
+    int expectedSize = 0;
+
+    for (int t = 0; t < ticks; t++) {
+        if (t == half) {
+            checkpointSize = GetWorldSnapshotSize(&world);
+            checkpoint = malloc(checkpointSize);
+            double start = Now();
+            SaveWorldSnapshot(&world, checkpoint, checkpointSize);
+            saveTime = Now() - start;
+            checkpointRng = botRng;
+        }
+        BotInputs(&world, &botRng, &inputs);
+        StepWorld(&world, &inputs, WORLD_DT);
+        CaptureRewind(&rewind, &world);
+        if (t == target) {
+            expectedSize = GetWorldSnapshotSize(&world);
+            expectedFrame = malloc(expectedSize);
+            SaveWorldSnapshot(&world, expectedFrame, expectedSize);
+        }
+    }
+    unsigned int expected = WorldChecksum(&world);
+    int rewindBytes = GetRewindBytes(&rewind);
+    float rewindSeconds = GetRewindSeconds(&rewind);
+
+    // Fresh world from the checkpoint
+    World restored;
+    InitWorld(&restored, WORLD_WIDTH, WORLD_HEIGHT, seed + 1);
+    bool loaded = LoadWorldSnapshot(&restored, checkpoint, checkpointSize);
+    botRng = checkpointRng;
+    for (int t = half; loaded && t < ticks; t++) {
+        BotInputs(&restored, &botRng, &inputs);
+        StepWorld(&restored, &inputs, WORLD_DT);
+    }
+    unsigned int fromCheckpoint = loaded ? WorldChecksum(&restored) : 0;
+
+    // Rewound state must be byte for byte the snapshot taken at that tick
+    double start = Now();
+    bool rewound = RestoreRewind(&rewind, &world, (lastCapture - target) / interval);
+    double restoreTime = Now() - start;
+    unsigned char *actualFrame = malloc(GetWorldSnapshotSize(&world));
+    int actualSize = SaveWorldSnapshot(&world, actualFrame, GetWorldSnapshotSize(&world));
+    rewound = rewound && actualSize == expectedSize && memcmp(actualFrame, expectedFrame, actualSize) == 0;
+
+    printf("checkpoint at tick %d: %d bytes, saved in %.1f us\n", half, checkpointSize, saveTime * 1e6);
+    printf("end checksum %08x, from checkpoint %08x: %s\n", expected, fromCheckpoint, (expected == fromCheckpoint) ? "match" : "MISMATCH");
+    printf("rewind to tick %d in %.1f us: %s\n", target, restoreTime * 1e6, rewound ? "match" : "MISMATCH");
+    printf("rewind history: %d bytes for %.1f s, %.1f KB per second of play\n", rewindBytes, rewindSeconds,
+           (rewindSeconds > 0.0f) ? rewindBytes / rewindSeconds / 1024.0f : 0.0f);
+
+    free(checkpoint);
+    free(expectedFrame);
+    free(actualFrame);
+    UnloadRewind(&rewind);
+    UnloadWorld(&restored);
+    UnloadWorld(&world);
+    return (expected == fromCheckpoint && rewound) ? 0 : 1;
+}
+
+// raylib's CheckCollisionPointCircle, which the collision loops used before the spatial hash
+static bool PointInCircle(Vector2 point, Vector2 center, float radius) {
+    float dx = point.x - center.x, dy = point.y - center.y;
+    return dx * dx + dy * dy <= radius * radius;
+}
+
+static int CompareInt(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+// Random layouts (grid size, cell size, crowd density, points past the edges) queried at
+// random spots and radii through every spatial hash query; each hit set must equal a
+// linear point in circle scan.
+static int CheckSpatialHash(unsigned int seed, int layouts) {
+    const int queries = 200;
+    unsigned int rng = seed * 2654435761u + 1;
+    #define RANDOM() (rng ^= rng << 13, rng ^= rng >> 17, rng ^= rng << 5, rng)
+    #define RANDOM_UNIT() ((RANDOM() & 0xffff) * (1.0f / 65536.0f))
+    SpatialHash hash;
+    InitSpatialHash(&hash);
+    int mismatches = 0, hits = 0;
+    long long tests = 0, brute = 0;
+
+    for (int layout = 0; layout < layouts; layout++) {
+        int width = 100 + (int)(RANDOM() % 1900), height = 100 + (int)(RANDOM() % 1100);
+        float cellSize = 8.0f + RANDOM_UNIT() * 120.0f;
+        int count = (int)(RANDOM() % 4000);
+        Vector2 *points = malloc(sizeof(Vector2) * (count ? count : 1));
+        int *order = malloc(sizeof(int) * (count ? count : 1));
+        int *expected = malloc(sizeof(int) * (count ? count : 1));
+        int *actual = malloc(sizeof(int) * (count ? count : 1));
+        Vector2 *actualPoints = malloc(sizeof(Vector2) * (count ? count : 1));
+
+        // Ids are inserted shuffled, so the ascending order of results is the hash's doing
+        for (int i = 0; i < count; i++) {
+            points[i] = (Vector2){(RANDOM_UNIT() * 1.2f - 0.1f) * width, (RANDOM_UNIT() * 1.2f - 0.1f) * height};
+            order[i] = i;
+        }
+        for (int i = count - 1; i > 0; i--) {
+            int j = (int)(RANDOM() % (unsigned int)(i + 1));
+            int swap = order[i];
+            order[i] = order[j];
+            order[j] = swap;
+        }
+        ResizeSpatialHash(&hash, width, height, cellSize);
+        BeginSpatialHash(&hash);
+        for (int i = 0; i < count; i++) InsertSpatialHash(&hash, order[i], points[order[i]]);
+        EndSpatialHash(&hash);
+
+        for (int q = 0; q < queries; q++) {
+            Vector2 center = {(RANDOM_UNIT() * 1.4f - 0.2f) * width, (RANDOM_UNIT() * 1.4f - 0.2f) * height};
+            float radius = (q % 10 == 0) ? 0.0f : RANDOM_UNIT() * cellSize * 3.0f;
+            int found = 0;
+            for (int i = 0; i < count; i++) {
+                if (PointInCircle(points[i], center, radius)) expected[found++] = i;
+            }
+            brute += count;
+            hits += found;
+
+            // Growing buffer: ids ascending
+            const int *ids;
+            int hashed = QuerySpatialHash(&hash, center, radius, &ids);
+            bool match = hashed == found && (found == 0 || memcmp(ids, expected, sizeof(int) * found) == 0);
+
+            // Caller's buffer: ascending when it fits, the full total either way
+            int total = QuerySpatialHashBuffer(&hash, center, radius, actual, count, NULL);
+            match = match && total == found && (found == 0 || memcmp(actual, expected, sizeof(int) * found) == 0);
+            match = match && QuerySpatialHashBuffer(&hash, center, radius, actual, found / 2, NULL) == found;
+
+            // Points with their ids in bucket order
+            int pointCount = QuerySpatialHashPoints(&hash, center, radius, actual, actualPoints, count);
+            bool pointsMatch = pointCount == found;
+            for (int k = 0; pointsMatch && k < pointCount; k++) {
+                pointsMatch = actualPoints[k].x == points[actual[k]].x && actualPoints[k].y == points[actual[k]].y;
+            }
+            if (pointsMatch && pointCount > 0) {
+                qsort(actual, pointCount, sizeof(int), CompareInt);
+                pointsMatch = memcmp(actual, expected, sizeof(int) * found) == 0;
+            }
+            match = match && pointsMatch;
+
+            if (!match) {
+                if (mismatches < 10) {
+                    printf("MISMATCH: layout %d (%dx%d, cell %.1f, %d points), query (%.1f, %.1f) r %.1f: "
+                           "%d expected, %d hashed\n", layout, width, height, cellSize, count, center.x, center.y,
+                           radius, found, hashed);
+                }
+                mismatches++;
+            }
+        }
+        tests += hash.tests;
+
+        free(points);
+        free(order);
+        free(expected);
+        free(actual);
+        free(actualPoints);
+    }
+    #undef RANDOM_UNIT
+    #undef RANDOM
+
+    printf("spatial hash: %d layouts x %d queries, %d hits, %lld distance checks vs %lld brute force: %s\n",
+           layouts, queries, hits, tests, brute, mismatches ? "MISMATCH" : "match");
+    UnloadSpatialHash(&hash);
+    return mismatches ? 1 : 0;
+}
+
+// Every handle handed out so far: live ones must resolve to the entity they were taken for,
+// released ones never again, also once their slot is reused. Returns the mismatches.
+static int CheckHandles(const EntityPool *pool, const int *tags, const EntityHandle *handles, const bool *live, int issued) {
+    int mismatches = 0;
+    for (int h = 0; h < issued; h++) {
+        int index = ResolveEntity(pool, handles[h]);
+        if (live[h] ? (index < 0 || tags[index] != h) : index >= 0) mismatches++;
+    }
+    return mismatches;
+}
+
+// Random spawns and O(1) swap-remove despawns on a pool whose owner array holds a tag per
+// entity, checking every handle after each operation; then the same through a world's
+// enemies, and across a snapshot of the pool slots.
+static int CheckEntityHandles(unsigned int seed, int operations) {
+    const int maxEntities = 256;
+    unsigned int rng = seed * 2654435761u + 1;
+    #define RANDOM() (rng ^= rng << 13, rng ^= rng >> 17, rng ^= rng << 5, rng)
+    EntityPool pool;
+    InitEntityPool(&pool, 16, maxEntities);
+    int *tags = malloc(sizeof(int) * maxEntities);
+    EntityHandle *handles = malloc(sizeof(EntityHandle) * operations);
+    bool *live = calloc(operations, sizeof(bool));
+    int issued = 0, released = 0, reused = 0, moved = 0, mismatches = 0;
+    bool *slotUsed = calloc(maxEntities, sizeof(bool));
+
+    for (int op = 0; op < operations && issued < operations; op++) {
+        bool spawn = pool.count == 0 || (pool.count < maxEntities && RANDOM() % 100 < 55);
+        if (spawn) {
+            if (!ReserveEntityPool(&pool, pool.count + 1)) break;
+            int index = AcquireEntity(&pool);
+            tags[index] = issued;
+            handles[issued] = GetEntityHandle(&pool, index);
+            if (slotUsed[handles[issued].slot]) reused++;
+            slotUsed[handles[issued].slot] = true;
+            live[issued++] = true;
+        } else {
+            int index = (int)(RANDOM() % (unsigned int)pool.count);
+            live[tags[index]] = false;
+            int last = ReleaseEntity(&pool, index);
+            if (last != index) moved++;
+            tags[index] = tags[last];       // The owner moves its data the way the pool did
+            released++;
+        }
+        mismatches += CheckHandles(&pool, tags, handles, live, issued);
+    }
+
+    // Slot state through a snapshot: a fresh pool resolves the same handles the same way
+    EntityPool restored;
+    InitEntityPool(&restored, 0, maxEntities);
+    int *entry = malloc(sizeof(int) * (pool.slotCount ? pool.slotCount : 1));
+    unsigned int *generation = malloc(sizeof(unsigned int) * (pool.slotCount ? pool.slotCount : 1));
+    SaveEntityPool(&pool, entry, generation);
+    bool loaded = LoadEntityPool(&restored, pool.count, pool.slotCount, pool.freeHead, entry, generation);
+    int snapshotMismatches = loaded ? CheckHandles(&restored, tags, handles, live, issued) : 1;
+
+    // Clearing stales everything
+    ClearEntityPool(&pool);
+    for (int h = 0; h < issued; h++) live[h] = false;
+    mismatches += CheckHandles(&pool, tags, handles, live, issued);
+
+    // World enemies: despawned handles stop resolving, the moved enemies keep theirs
+    World world;
+    InitWorld(&world, WORLD_WIDTH, WORLD_HEIGHT, seed);
+    world.enemyLimit = 64;
+    int spawned = SpawnEnemies(&world, 64);
+    EntityHandle enemyHandles[128];
+    Vector2 enemyPositions[128];
+    bool enemyLive[128];
+    for (int i = 0; i < spawned; i++) {
+        enemyHandles[i] = GetEntityHandle(&world.enemyPool, i);
+        enemyPositions[i] = world.enemies[i].position;
+        enemyLive[i] = true;
+    }
+    int despawned = 0;
+    for (int k = 0; k < spawned / 2; k++) {
+        int target = (int)(RANDOM() % (unsigned int)spawned);
+        int index = ResolveEntity(&world.enemyPool, enemyHandles[target]);
+        if (index < 0) continue;
+        DespawnEnemy(&world, index);
+        enemyLive[target] = false;
+        despawned++;
+    }
+    int respawned = SpawnEnemies(&world, 64);
+    for (int i = 0; i < spawned; i++) {
+        int index = ResolveEntity(&world.enemyPool, enemyHandles[i]);
+        bool ok = enemyLive[i] ? (index >= 0 && world.enemies[index].position.x == enemyPositions[i].x &&
+                                  world.enemies[index].position.y == enemyPositions[i].y) : index < 0;
+        if (!ok) mismatches++;
+    }
+    #undef RANDOM
+
+    printf("handles: %d issued, %d released (%d moved an entity), %d reused a slot; world: %d enemies, "
+           "%d despawned, %d respawned: %s\n", issued, released, moved, reused, spawned, despawned,
+           respawned, mismatches ? "MISMATCH" : "match");
+    printf("handles after snapshot of the slots: %s\n", snapshotMismatches ? "MISMATCH" : "match");
+
+    UnloadWorld(&world);
+    UnloadEntityPool(&restored);
+    UnloadEntityPool(&pool);
+    free(entry);
+    free(generation);
+    free(slotUsed);
+    free(live);
+    free(handles);
+    free(tags);
+    return (mismatches || snapshotMismatches) ? 1 : 0;
+}
+
+static int CompareDouble(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double Percentile(const double *sorted, int count, double p) {
+    int i = (int)(p * (count - 1) + 0.5);
+    return sorted[i];
+}
+
+// Replay each recording several times on this thread and report step time percentiles per
+// phase. Inputs are fixed, so differences between commits come from the code alone.
+static int RunPerf(const char **paths, int pathCount, int repeats, const char *csvPath) {
+    static const char *phaseNames[WORLD_PHASE_COUNT + 1] = {
+        "player", "lasers", "enemies", "grid", "collisions", "particles", "total"
+    };
+    FILE *csv = NULL;
+    if (csvPath) {
+        csv = fopen(csvPath, "w");
+        if (!csv) {
+            fprintf(stderr, "cannot write %s\n", csvPath);
+            return 1;
+        }
+        fprintf(csv, "recording,phase,p50_us,p90_us,p99_us,max_us,mean_us\n");
+    }
+
+    for (int f = 0; f < pathCount; f++) {
+        InputRecording rec;
+        if (!LoadRecording(&rec, paths[f]) || rec.ticks == 0) {
+            fprintf(stderr, "cannot read %s\n", paths[f]);
+            if (csv) fclose(csv);
+            return 1;
+        }
+
+        int samples = rec.ticks * repeats;
+        double *phaseSamples = malloc(sizeof(double) * WORLD_PHASE_COUNT * rec.ticks);
+        double *series[WORLD_PHASE_COUNT + 1];
+        for (int p = 0; p <= WORLD_PHASE_COUNT; p++) series[p] = malloc(sizeof(double) * samples);
+
+        for (int r = 0; r < repeats; r++) {
+            World world;
+            InitRecordedWorld(&world, &rec);
+            world.clock = Now;
+            ReplaySession(&world, &rec, phaseSamples);
+            UnloadWorld(&world);
+
+            for (int t = 0; t < rec.ticks; t++) {
+                double total = 0.0;
+                for (int p = 0; p < WORLD_PHASE_COUNT; p++) {
+                    double seconds = phaseSamples[(size_t)t * WORLD_PHASE_COUNT + p];
+                    series[p][r * rec.ticks + t] = seconds;
+                    total += seconds;
+                }
+                series[WORLD_PHASE_COUNT][r * rec.ticks + t] = total;
+            }
+        }
+
+        printf("%s: %d ticks x %d runs\n", paths[f], rec.ticks, repeats);
+        printf("  %-10s %9s %9s %9s %9s %9s\n", "phase", "p50 us", "p90 us", "p99 us", "max us", "mean us");
+        for (int p = 0; p <= WORLD_PHASE_COUNT; p++) {
+            double sum = 0.0;
+            for (int i = 0; i < samples; i++) sum += series[p][i];
+            qsort(series[p], samples, sizeof(double), CompareDouble);
+            double p50 = Percentile(series[p], samples, 0.50) * 1e6;
+            double p90 = Percentile(series[p], samples, 0.90) * 1e6;
+            double p99 = Percentile(series[p], samples, 0.99) * 1e6;
+            double max = series[p][samples - 1] * 1e6;
+            double mean = sum / samples * 1e6;
+            printf("  %-10s %9.2f %9.2f %9.2f %9.2f %9.2f\n", phaseNames[p], p50, p90, p99, max, mean);
+            if (csv) fprintf(csv, "%s,%s,%.3f,%.3f,%.3f,%.3f,%.3f\n", paths[f], phaseNames[p], p50, p90, p99, max, mean);
+            free(series[p]);
+        }
+
+        free(phaseSamples);
+        UnloadRecording(&rec);
+    }
+
+    if (csv) fclose(csv);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int worldCount = 4096;
+    int ticks = 60 * WORLD_TICK_RATE;   // One simulated minute per world
+    int threadCount = GetCpuCount();     // Worlds are split across threads, StepWorld itself runs inline
+    unsigned int seed = 1;
+    const char *csvPath = NULL;
+    const char *recordPath = NULL;
+    const char *replayPath = NULL;
+    const char *perfPaths[64];
+    int perfCount = 0;
+    int repeats = 0;                    // -n, 5 perf runs, 64 spatial hash layouts or 20000 handle operations when not given
+    int enemies = 0;
+    bool checkSnapshots = false;
+    bool checkSpatial = false;
+    bool checkHandles = false;
+    const char *renderPath = NULL;
+    int renderWidth = 960;
+    int frameTicks = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-w") && i + 1 < argc) worldCount = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc) ticks = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-j") && i + 1 < argc) threadCount = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-s") && i + 1 < argc) seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        else if (!strcmp(argv[i], "-o") && i + 1 < argc) csvPath = argv[++i];
+        else if (!strcmp(argv[i], "-R") && i + 1 < argc) recordPath = argv[++i];
+        else if (!strcmp(argv[i], "-r") && i + 1 < argc) replayPath = argv[++i];
+        else if (!strcmp(argv[i], "-p") && i + 1 < argc && perfCount < 64) perfPaths[perfCount++] = argv[++i];
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc) repeats = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-e") && i + 1 < argc) enemies = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-c")) checkSnapshots = true;
+        else if (!strcmp(argv[i], "-g")) checkSpatial = true;
+        else if (!strcmp(argv[i], "-H")) checkHandles = true;
+        else if (!strcmp(argv[i], "-v") && i + 1 < argc) renderPath = argv[++i];
+        else if (!strcmp(argv[i], "-W") && i + 1 < argc) renderWidth = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-f") && i + 1 < argc) frameTicks = atoi(argv[++i]);
+        else {
+            fprintf(stderr, "usage: %s [-w worlds] [-t ticks] [-j threads] [-s seed] [-e enemies] [-o stats.csv]\n"
+                            "       %s -R session.rec [-t ticks] [-s seed] [-e enemies]\n"
+                            "       %s -r session.rec\n"
+                            "       %s -p session.rec [-p ...] [-n repeats] [-o perf.csv]\n"
+                            "       %s -c [-t ticks] [-s seed] [-e enemies]\n"
+                            "       %s -g [-n layouts] [-s seed]\n"
+                            "       %s -H [-n operations] [-s seed]\n"
+                            "       %s -v out.rgba|-|frame%%06d.png [-r session.rec | -t ticks -s seed -e enemies] [-W width] [-f ticks]\n",
+                    argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0]);
+            return 1;
+        }
+    }
+    if (renderPath) {
+        // At least the narrowest width that still leaves one row of pixels
+        const int minWidth = (WORLD_WIDTH + WORLD_HEIGHT - 1) / WORLD_HEIGHT;
+        if (renderWidth <= 0) renderWidth = 960;
+        return RenderSession(renderPath, replayPath, seed, ticks, enemies, (renderWidth > minWidth) ? renderWidth : minWidth,
+                             (frameTicks > 0) ? frameTicks : 1);
+    }
+    if (checkSnapshots) return CheckSnapshots(seed, ticks, enemies);
+    if (checkSpatial) return CheckSpatialHash(seed, (repeats > 0) ? repeats : 64);
+    if (checkHandles) return CheckEntityHandles(seed, (repeats > 0) ? repeats : 20000);
+    if (recordPath) return RecordSession(recordPath, seed, ticks, enemies);
+    if (replayPath) return ReplayFile(replayPath);
+    if (perfCount > 0) return RunPerf(perfPaths, perfCount, (repeats > 0) ? repeats : 5, csvPath);
+
+    if (worldCount < 1) worldCount = 1;
+    if (threadCount < 1) threadCount = 1;
+    if (threadCount > worldCount) threadCount = worldCount;
+
+    World *worlds = malloc(sizeof(World) * worldCount);
+    WorldStats *stats = calloc(worldCount, sizeof(WorldStats));
+    Worker *workers = malloc(sizeof(Worker) * threadCount);
+    pthread_t *threads = malloc(sizeof(pthread_t) * threadCount);
+    if (!worlds || !stats || !workers || !threads) {
+        fprintf(stderr, "out of memory for %d worlds\n", worldCount);
+        return 1;
+    }
+
+    for (int w = 0; w < worldCount; w++) {
+        stats[w].seed = seed + (unsigned int)w;
+        InitWorld(&worlds[w], WORLD_WIDTH, WORLD_HEIGHT, stats[w].seed);
+        SetEnemyHorde(&worlds[w], enemies);
+    }
+
+    // Worlds never interact, so each thread owns a contiguous slice and runs it to the end
+    double start = Now();
+    for (int t = 0; t < threadCount; t++) {
+        workers[t] = (Worker){worlds, stats, (int)((long long)worldCount * t / threadCount),
+                              (int)((long long)worldCount * (t + 1) / threadCount), ticks};
+        pthread_create(&threads[t], NULL, RunWorker, &workers[t]);
+    }
+    for (int t = 0; t < threadCount; t++) pthread_join(threads[t], NULL);
+    double elapsed = Now() - start;
+
+    long long totalDeaths = 0, totalKills = 0;
+    for (int w = 0; w < worldCount; w++) {
+        totalDeaths += stats[w].deaths;
+        totalKills += stats[w].kills;
+    }
+
+    double worldTicks = (double)worldCount * ticks;
+    double simulated = worldTicks * WORLD_DT;
+    printf("worlds %d, ticks %d, threads %d: %.3f s\n", worldCount, ticks, threadCount, elapsed);
+    printf("%.0f world ticks/s, %.0fx real time, %lld kills, %lld deaths\n",
+           worldTicks / elapsed, simulated / elapsed, totalKills, totalDeaths);
+
+    if (csvPath) {
+        FILE *file = fopen(csvPath, "w");
+        if (!file) {
+            fprintf(stderr, "cannot write %s\n", csvPath);
+            return 1;
+        }
+        fprintf(file, "world,seed,deaths,kills,best_score,final_score\n");
+        for (int w = 0; w < worldCount; w++) {
+            fprintf(file, "%d,%u,%d,%d,%d,%d\n", w, stats[w].seed, stats[w].deaths,
+                    stats[w].kills, stats[w].bestScore, worlds[w].score);
+        }
+        fclose(file);
+    }
+
+    for (int w = 0; w < worldCount; w++) UnloadWorld(&worlds[w]);
+    free(threads);
+    free(workers);
+    free(stats);
+    free(worlds);
+    return 0;
+}
@@ -0,0 +1,177 @@
+#include "hud.h"
+#include "rlgl.h"
+#include <stdio.h>
+#include <string.h>
+
+// Define fixed font sizes for specific texts
+#define FIXED_FONT_SIZE_SOCIAL 10       // For "X kirbara2000"
+#define FIXED_FONT_SIZE_TRY_AGAIN 20    // For "Nah, I'd Win"
+
+static const char *titleText = "RAGE AGAINST THE DYING INTERNET";
+static const char *subText = "Make your own website, fill with ur SOUL & fuck the SLOP!";
+static const char *controlText = "ARROW and SPACE to control your Spaceship";
+static const char *bottomTextLine1 = "This site is written in C, Raylib, Wasm, & Grok.";
+static const char *bottomTextLine2 = "Techzz is crazyy. U can do THINGS!";
+static const char *pressTabText = "press TAB";
+
+static void LayoutHud(Hud *hud) {
+    int screenWidth = hud->width;
+    int screenHeight = hud->height;
+
+    // Calculate font size for scaling text (except for fixed-size text)
+    hud->fontSize = (int)(screenWidth / 50.0f);
+    if (hud->fontSize < 10) hud->fontSize = 10; // Minimum font size
+    int fontSize = hud->fontSize;
+
+    hud->titleX = (screenWidth - MeasureText(titleText, fontSize)) / 2;
+    hud->titleY = 10;
+
+    // Social media button sits under the subtext and control text
+    int controlY = hud->titleY + fontSize + 10 + fontSize / 2 + 10;
+    int buttonWidth = 100;
+    int buttonHeight = 20;
+    hud->buttonRect = (Rectangle){(screenWidth - buttonWidth) / 2, controlY + fontSize / 2 + 10, buttonWidth, buttonHeight};
+
+    // Score or game over text (moved up to avoid overlap)
+    hud->scoreY = screenHeight - (fontSize + fontSize / 2 + 40);
+
+    // "Try Again" button
+    hud->tryAgainButton = (Rectangle){(screenWidth - 200) / 2, screenHeight / 2, 200, 50};
+}
+
+static void DrawCentered(const char *text, int width, int y, int fontSize, Color color) {
+    DrawText(text, (width - MeasureText(text, fontSize)) / 2, y, fontSize, color);
+}
+
+static void DrawHudTitle(const Hud *hud) {
+    Color colors[] = {BLUE, RED, GREEN, WHITE, MAGENTA};
+    DrawText(titleText, hud->titleX, hud->titleY, hud->fontSize, colors[hud->colorIndex]);
+}
+
+static void DrawHudScore(const Hud *hud) {
+    char scoreText[64];
+    if (!hud->gameOver) sprintf(scoreText, "Score: %d", hud->score);
+    else sprintf(scoreText, "IT'S SO OVER. TOTAL: %d", hud->score);
+    DrawCentered(scoreText, hud->width, hud->scoreY, hud->fontSize, YELLOW);
+}
+
+static void DrawHudButton(Rectangle rect, const char *label, int fontSize, bool hovered) {
+    DrawRectangleRec(rect, hovered ? YELLOW : WHITE);
+    int textX = rect.x + (rect.width - MeasureText(label, fontSize)) / 2;
+    int textY = rect.y + (rect.height - fontSize) / 2;
+    DrawText(label, textX, textY, fontSize, BLACK);
+}
+
+// Text that only changes with the layout or game over state
+static void DrawHudStatic(const Hud *hud) {
+    int fontSize = hud->fontSize;
+    int subY = hud->titleY + fontSize + 10;
+    int controlY = subY + fontSize / 2 + 10;
+    DrawCentered(subText, hud->width, subY, fontSize / 2, WHITE);
+    DrawCentered(controlText, hud->width, controlY, fontSize / 2, Fade(WHITE, 0.5f));
+
+    if (hud->gameOver) {
+        // Draw "press TAB" text, 10 pixels below the button
+        int pressTabFontSize = FIXED_FONT_SIZE_TRY_AGAIN / 2;
+        int pressTabX = hud->tryAgainButton.x + (hud->tryAgainButton.width - MeasureText(pressTabText, pressTabFontSize)) / 2;
+        int pressTabY = hud->tryAgainButton.y + hud->tryAgainButton.height + 10;
+        DrawText(pressTabText, pressTabX, pressTabY, pressTabFontSize, Fade(WHITE, 0.5f));
+    }
+
+    // Bottom text split into two lines
+    int bottomYLine1 = hud->height - (fontSize / 2 + 5 + fontSize / 2 + 10);
+    int bottomYLine2 = bottomYLine1 + fontSize / 2 + 5;
+    DrawCentered(bottomTextLine1, hud->width, bottomYLine1, fontSize / 2, Fade(WHITE, 0.5f));
+    DrawCentered(bottomTextLine2, hud->width, bottomYLine2, fontSize / 2, Fade(WHITE, 0.5f));
+}
+
+// Clear one region of the texture and let draw() repaint it
+static void RedrawRegion(Hud *hud, Rectangle region, void (*draw)(const Hud *)) {
+    BeginScissorMode((int)region.x, (int)region.y, (int)region.width, (int)region.height);
+    ClearBackground(BLANK);
+    draw(hud);
+    EndScissorMode();
+    hud->redraws++;
+}
+
+static void DrawHudSocialButton(const Hud *hud) {
+    DrawHudButton(hud->buttonRect, "X kirbara2000", FIXED_FONT_SIZE_SOCIAL, hud->buttonHovered);
+}
+
+static void DrawHudTryAgainButton(const Hud *hud) {
+    DrawHudButton(hud->tryAgainButton, "Nah, I'd Win", FIXED_FONT_SIZE_TRY_AGAIN, hud->tryAgainHovered);
+}
+
+void LoadHud(Hud *hud, int width, int height) {
+    memset(hud, 0, sizeof(*hud));
+    hud->target = LoadRenderTexture(width, height);
+    hud->width = width;
+    hud->height = height;
+    hud->dirty = true;
+    LayoutHud(hud);
+}
+
+void UnloadHud(Hud *hud) {
+    UnloadRenderTexture(hud->target);
+    memset(hud, 0, sizeof(*hud));
+}
+
+void ResizeHud(Hud *hud, int width, int height) {
+    if (width == hud->width && height == hud->height) return;
+    UnloadRenderTexture(hud->target);
+    hud->target = LoadRenderTexture(width, height);
+    hud->width = width;
+    hud->height = height;
+    hud->dirty = true;
+    LayoutHud(hud);
+}
+
+void UpdateHud(Hud *hud, int colorIndex, int score, bool gameOver, Vector2 mouse) {
+    bool full = hud->dirty || gameOver != hud->gameOver;
+    hud->dirty = false;
+    hud->redraws = 0;
+
+    bool buttonHovered = CheckCollisionPointRec(mouse, hud->buttonRect);
+    bool tryAgainHovered = gameOver && CheckCollisionPointRec(mouse, hud->tryAgainButton);
+    bool titleDirty = colorIndex != hud->colorIndex;
+    bool scoreDirty = score != hud->score;
+    bool buttonDirty = buttonHovered != hud->buttonHovered;
+    bool tryAgainDirty = tryAgainHovered != hud->tryAgainHovered;
+    if (!full && !titleDirty && !scoreDirty && !buttonDirty && !tryAgainDirty) return;
+
+    hud->colorIndex = colorIndex;
+    hud->score = score;
+    hud->gameOver = gameOver;
+    hud->buttonHovered = buttonHovered;
+    hud->tryAgainHovered = tryAgainHovered;
+
+    // Keep the texture premultiplied: color blends as usual, alpha accumulates coverage
+    BeginTextureMode(hud->target);
+    rlSetBlendFactorsSeparate(RL_SRC_ALPHA, RL_ONE_MINUS_SRC_ALPHA, RL_ONE, RL_ONE_MINUS_SRC_ALPHA, RL_FUNC_ADD, RL_FUNC_ADD);
+    BeginBlendMode(BLEND_CUSTOM_SEPARATE);
+
+    if (full) {
+        ClearBackground(BLANK);
+        DrawHudTitle(hud);
+        DrawHudStatic(hud);
+        DrawHudSocialButton(hud);
+        DrawHudScore(hud);
+        if (gameOver) DrawHudTryAgainButton(hud);
+        hud->redraws = 1;
+    } else {
+        if (titleDirty) RedrawRegion(hud, (Rectangle){0, hud->titleY, hud->width, hud->fontSize}, DrawHudTitle);
+        if (scoreDirty) RedrawRegion(hud, (Rectangle){0, hud->scoreY, hud->width, hud->fontSize}, DrawHudScore);
+        if (buttonDirty) RedrawRegion(hud, hud->buttonRect, DrawHudSocialButton);
+        if (tryAgainDirty) RedrawRegion(hud, hud->tryAgainButton, DrawHudTryAgainButton);
+    }
+
+    EndBlendMode();
+    EndTextureMode();
+}
+
+void DrawHud(const Hud *hud) {
+    // Render textures are stored upside down, flip with a negative source height
+    BeginBlendMode(BLEND_ALPHA_PREMULTIPLY);
+    DrawTextureRec(hud->target.texture, (Rectangle){0, 0, (float)hud->width, (float)-hud->height}, (Vector2){0, 0}, WHITE);
+    EndBlendMode();
+}
@@ -0,0 +1,39 @@
+#ifndef HUD_H
+#define HUD_H
+
+#include "raylib.h"
+
+// Cached UI layer: all HUD text and buttons live in a RenderTexture2D that is laid out and
+// fully redrawn only on resize or game over, with the title, score and button regions
+// patched in place when their color, value or hover state changes.
+// The frame then composites it with a single textured quad.
+typedef struct {
+    RenderTexture2D target;     // Premultiplied alpha, drawn with BLEND_ALPHA_PREMULTIPLY
+    int width;
+    int height;
+
+    // Layout, recomputed on resize
+    int fontSize;
+    int titleX, titleY;
+    int scoreY;
+    Rectangle buttonRect;       // "X kirbara2000" social button
+    Rectangle tryAgainButton;   // "Nah, I'd Win" button
+
+    // State currently rasterized in the texture
+    int colorIndex;
+    int score;
+    bool gameOver;
+    bool buttonHovered;
+    bool tryAgainHovered;
+
+    bool dirty;                 // Layout changed, next update redraws everything
+    int redraws;                // Regions redrawn last update (0 when nothing changed)
+} Hud;
+
+void LoadHud(Hud *hud, int width, int height);
+void UnloadHud(Hud *hud);
+void ResizeHud(Hud *hud, int width, int height);       // Relayout, button rects are valid right away
+void UpdateHud(Hud *hud, int colorIndex, int score, bool gameOver, Vector2 mouse);     // Call outside BeginDrawing
+void DrawHud(const Hud *hud);
+
+#endif // HUD_H
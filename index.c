@@ -1,190 +1,144 @@
 #include "raylib.h"
-#include <stdio.h>
+#include "world.h"
+#include "batch.h"
+#include "hud.h"
+#include "viewport.h"
+#include "replay.h"
+#include "input.h"
+#include "simulation.h"
+#include "profiler.h"
+#include "quality.h"
+#include "fastmath.h"
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <math.h>
-
-// Define constants for maximum limits
-#define MAX_LASERS 100
-#define MAX_ENEMIES 10
-#define MAX_PARTICLES 100
-
-// Define structures for game objects
-typedef struct {
-    Vector2 position;   // Position of the spaceship
-    float rotation;     // Rotation angle in degrees
-    float speed;        // Movement speed
-} Spaceship;
-
-typedef struct {
-    Vector2 position;   // Position of the laser
-    float rotation;     // Rotation angle in degrees
-    float speed;        // Movement speed
-    bool active;        // Whether the laser is active
-} Laser;
-
-typedef struct {
-    Vector2 position;   // Position of the enemy
-    float speed;        // Movement speed
-    bool active;        // Whether the enemy is active
-} Enemy;
-
-typedef struct {
-    Vector2 position;   // Position of the particle
-    Vector2 velocity;   // Movement direction and speed
-    Color color;        // Color of the particle
-    float alpha;        // Transparency (0.0 to 1.0)
-    float life;         // Remaining lifetime
-} Particle;
-
-// Helper function to get touch position by ID
-Vector2 GetTouchPositionByID(int id) {
-    for (int i = 0; i < GetTouchPointCount(); i++) {
-        if (GetTouchPointId(i) == id) {
-            return GetTouchPosition(i);
-        }
-    }
-    return (Vector2){-1, -1}; // Invalid position
+#if defined(__EMSCRIPTEN__)
+    #include <emscripten/emscripten.h>
+#endif
+
+// Blend between the last two simulation steps; big jumps (screen wrap, restart) snap instead
+Vector2 LerpPosition(Vector2 prev, Vector2 cur, float t) {
+    if (fabsf(cur.x - prev.x) > 100.0f || fabsf(cur.y - prev.y) > 100.0f) return cur;
+    return (Vector2){prev.x + (cur.x - prev.x) * t, prev.y + (cur.y - prev.y) * t};
 }
 
-// Function to calculate shortest angle between two angles
-float ShortestAngle(float from, float to) {
-    float diff = fmodf(to - from, 360.0f);
-    if (diff > 180.0f) diff -= 360.0f;
-    if (diff < -180.0f) diff += 360.0f;
-    return diff;
+// Blend two angles in degrees the short way round
+float LerpAngle(float from, float to, float t) {
+    return from + FastAngleDelta(from, to) * t;
 }
 
-int main(void) {
+// Usage: index [-s seed] [-e enemies] [-R record.rec] [-r replay.rec]
+int main(int argc, char **argv) {
+    unsigned int seed = (unsigned int)time(NULL);
+    const char *recordPath = NULL;
+    const char *replayPath = NULL;
+    int enemies = 0;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "-s")) seed = (unsigned int)strtoul(argv[i + 1], NULL, 10);
+        else if (!strcmp(argv[i], "-e")) enemies = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-R")) recordPath = argv[i + 1];
+        else if (!strcmp(argv[i], "-r")) replayPath = argv[i + 1];
+    }
+
+    // Full rate while playing. A game over screen left alone drops to idleFrameRate: the
+    // simulation still runs every tick, but frames, HUD updates and presents are 6x fewer.
+    const int fullFrameRate = 60;
+    const int idleFrameRate = 10;
+    const double idleDelay = 2.0;               // Seconds without input before idling
+    const int idleMaxParticles = 256;           // Let the death explosion settle first
+
     // Enable resizable window
     SetConfigFlags(FLAG_WINDOW_RESIZABLE | FLAG_VSYNC_HINT);
     InitWindow(1920, 1080, "Fun Internet"); // Initial size, will adjust on resize
-    SetTargetFPS(60);
-
-    // Define constant sizes for game objects (in pixels, not scaled with window)
-    const float shipSize = 20.0f;       // Size of the spaceship
-    const float enemyRadius = 10.0f;    // Radius of enemies
-    const float laserLength = 10.0f;    // Length of lasers
-
-    // Initialize game objects
-    Spaceship player = {0};
-    Laser lasers[MAX_LASERS] = {0};
-    Enemy enemies[MAX_ENEMIES] = {0};
-    Particle particles[MAX_PARTICLES] = {0};
-
-    // Game state variables
-    int score = 0;
-    bool playerExploded = false;
-
-    // Random seed
-    srand(time(NULL));
-
-    // Touch control variables
-    int prevTouchCount = 0;
-    int prevTouchIDs[10] = {0};
-    int joystickTouchID = -1;
-    int fireTouchID = -1;
-    bool fireTriggered = false;
-
-    // Variables to track previous window size for scaling positions
-    static int prevWidth = 0;
-    static int prevHeight = 0;
-
-    // Flag for first frame initialization
-    bool firstFrame = true;
+    SetTargetFPS(fullFrameRate);
+
+    // Simulation runs at WORLD_TICK_RATE whatever the frame rate, rendering interpolates
+    const float tickFrames = WORLD_DT * 60.0f;  // Velocities are per 60 Hz frame
+    bool idle = false;
+
+    // Batched renderer for all entity and touch control sprites
+    SpriteBatch batch;
+    LoadSpriteBatch(&batch);
+    bool showStats = false;
+
+    // Cached UI layer, only redrawn when something on it changes
+    Hud hud;
+    LoadHud(&hud, GetScreenWidth(), GetScreenHeight());
+
+    // Initialize game world in its fixed logical space, player starts in the middle.
+    // A replay restores the recorded seed and playfield and feeds its inputs until it runs out.
+    InputRecording session = {0};
+    bool replaying = replayPath && LoadRecording(&session, replayPath);
+    bool recording = !replaying && recordPath;
+    if (replayPath && !replaying) TraceLog(LOG_WARNING, "REPLAY: Failed to load %s", replayPath);
+    World world;
+    if (replaying) {
+        InitRecordedWorld(&world, &session);
+    } else {
+        InitWorld(&world, WORLD_WIDTH, WORLD_HEIGHT, seed);
+        if (enemies > 0) {
+            // Horde mode: every spawn wave tops the crowd up to this many
+            world.enemyLimit = enemies;
+            world.enemyWave = enemies;
+        }
+        if (recording) BeginRecording(&session, &world, seed);
+    }
+    PROFILE_ATTACH_WORLD(&world);
+
+    // Camera from world units to the window, F6 switches between letterbox and extend
+    Viewport viewport;
+    InitViewport(&viewport, world.width, world.height, VIEWPORT_LETTERBOX);
+#if defined(PROFILER_ENABLED)
+    bool showProfiler = false;
+#endif
+
+    // Keys and touches, polled here and handed to the simulation every frame
+    InputState input;
+    InitInput(&input);
+
+    // From here on the world belongs to the simulation thread, frames draw its published
+    // states. It and its job helpers get every core but the one drawing.
+    Simulation sim;
+    StartSimulation(&sim, &world, (recording || replaying) ? &session : NULL, recording, replaying, GetTime, GetCpuCount() - 2);
+    const RenderState *state = GetRenderState(&sim);
+
+    // Work per second of wall time for the F3 report: time spent in frames outside the
+    // frame cap wait, a CPU use proxy that also works in the browser
+    double busyTime = 0.0;
+    double busyWindowStart = GetTime();
+    float busyPercent = 0.0f;
+    int busyFrames = 0;
+    int framesPerSecond = 0;
+
+    // Sheds effects when frames run over the 60 fps budget, brings them back once there is
+    // headroom again. Idle frames are slow on purpose and not measured.
+    QualityGovernor quality;
+    InitQuality(&quality, 1.0f / fullFrameRate);
+    double previousFrameStart = GetTime();
+    int hudFrames = 0;
+    bool presented = false;
 
     // Main game loop
     while (!WindowShouldClose()) {
+        double frameStart = GetTime();
+        double frameInterval = frameStart - previousFrameStart;
+        previousFrameStart = frameStart;
+        bool paced = idle;      // Interval set by the idle frame cap, not by the frame's work
+        QualitySettings settings = GetQualitySettings(&quality);
+        PROFILE_FRAME_BEGIN();
+        PROFILE_BEGIN(PROFILE_LAYOUT);
+
         // Get current screen dimensions
         int screenWidth = GetScreenWidth();
         int screenHeight = GetScreenHeight();
 
-        // Initialize player position on first frame or after reset
-        if (firstFrame) {
-            player.position = (Vector2){screenWidth / 2.0f, screenHeight / 2.0f};
-            player.rotation = 0.0f;
-            player.speed = 0.0f;
-            firstFrame = false;
-        }
-
-        // Scale positions of all objects when window is resized
-        if (prevWidth != 0 && prevHeight != 0 && (prevWidth != screenWidth || prevHeight != screenHeight)) {
-            float scaleX = (float)screenWidth / prevWidth;
-            float scaleY = (float)screenHeight / prevHeight;
+        // Fit the playfield to the window, only the camera changes on resize
+        if (IsKeyPressed(KEY_F6)) viewport.policy = (viewport.policy == VIEWPORT_LETTERBOX) ? VIEWPORT_EXTEND : VIEWPORT_LETTERBOX;
+        UpdateViewport(&viewport, screenWidth, screenHeight);
 
-            player.position.x *= scaleX;
-            player.position.y *= scaleY;
-
-            for (int i = 0; i < MAX_LASERS; i++) {
-                if (lasers[i].active) {
-                    lasers[i].position.x *= scaleX;
-                    lasers[i].position.y *= scaleY;
-                }
-            }
-
-            for (int i = 0; i < MAX_ENEMIES; i++) {
-                if (enemies[i].active) {
-                    enemies[i].position.x *= scaleX;
-                    enemies[i].position.y *= scaleY;
-                }
-            }
-
-            for (int i = 0; i < MAX_PARTICLES; i++) {
-                if (particles[i].life > 0) {
-                    particles[i].position.x *= scaleX;
-                    particles[i].position.y *= scaleY;
-                }
-            }
-        }
-        prevWidth = screenWidth;
-        prevHeight = screenHeight;
-
-        // Calculate font size for scaling text (except for fixed-size text)
-        int fontSize = (int)(screenWidth / 50.0f);
-        if (fontSize < 10) fontSize = 10; // Minimum font size
-
-        // Define fixed font sizes for specific texts
-        const int fixedFontSizeSocial = 10; // For "X kirbara2000"
-        const int fixedFontSizeTryAgain = 20; // For "Nah, I'd Win"
-
-        // Top text
-        const char* titleText = "RAGE AGAINST THE DYING INTERNET";
-        int titleWidth = MeasureText(titleText, fontSize);
-        int titleX = (screenWidth - titleWidth) / 2;
-        int titleY = 10;
-
-        // Subtext
-        const char* subText = "Make your own website, fill with ur SOUL & fuck the SLOP!";
-        int subWidth = MeasureText(subText, fontSize / 2);
-        int subX = (screenWidth - subWidth) / 2;
-        int subY = titleY + fontSize + 10;
-
-        // Control text
-        const char* controlText = "ARROW and SPACE to control your Spaceship";
-        int controlWidth = MeasureText(controlText, fontSize / 2);
-        int controlX = (screenWidth - controlWidth) / 2;
-        int controlY = subY + fontSize / 2 + 10;
-
-        // Social media button
-        int buttonWidth = 100;
-        int buttonHeight = 20;
-        Rectangle buttonRect = {(screenWidth - buttonWidth) / 2, controlY + fontSize / 2 + 10, buttonWidth, buttonHeight};
-
-        // Bottom text split into two lines
-        const char* bottomTextLine1 = "This site is written in C, Raylib, Wasm, & Grok.";
-        const char* bottomTextLine2 = "Techzz is crazyy. U can do THINGS!";
-        int bottomWidthLine1 = MeasureText(bottomTextLine1, fontSize / 2);
-        int bottomWidthLine2 = MeasureText(bottomTextLine2, fontSize / 2);
-        int bottomXLine1 = (screenWidth - bottomWidthLine1) / 2;
-        int bottomXLine2 = (screenWidth - bottomWidthLine2) / 2;
-        int bottomYLine1 = screenHeight - (fontSize / 2 + 5 + fontSize / 2 + 10);
-        int bottomYLine2 = bottomYLine1 + fontSize / 2 + 5;
-
-        // Score or game over text (moved up to avoid overlap)
-        int scoreY = screenHeight - (fontSize + fontSize / 2 + 40);
-
-        // "Try Again" button
-        Rectangle tryAgainButton = {(screenWidth - 200) / 2, screenHeight / 2, 200, 50};
+        // Lay out the cached HUD for the new size, button rects are needed for input below
+        ResizeHud(&hud, screenWidth, screenHeight);
 
         // Touch controller positions
         float controllerSize = fminf(screenWidth, screenHeight) * 0.1f;
@@ -203,370 +157,195 @@ int main(void) {
             fireButtonCenter = (Vector2){screenWidth * 0.75f, screenHeight * 0.8f};
         }
 
-        // Touch control logic
-        int touchCount = GetTouchPointCount();
-        int currentTouchIDs[10] = {0};
-        for (int i = 0; i < touchCount; i++) {
-            currentTouchIDs[i] = GetTouchPointId(i);
-        }
-
-        // Detect new touches
-        for (int i = 0; i < touchCount; i++) {
-            int touchID = currentTouchIDs[i];
-            bool isNew = true;
-            for (int j = 0; j < prevTouchCount; j++) {
-                if (prevTouchIDs[j] == touchID) {
-                    isNew = false;
-                    break;
-                }
-            }
-            if (isNew) {
-                Vector2 touchPos = GetTouchPosition(i);
-                if (CheckCollisionPointCircle(touchPos, joystickCenter, joystickRadius)) {
-                    if (joystickTouchID == -1) {
-                        joystickTouchID = touchID;
-                    }
-                } else if (CheckCollisionPointCircle(touchPos, fireButtonCenter, fireButtonRadius)) {
-                    if (fireTouchID == -1) {
-                        fireTouchID = touchID;
-                        fireTriggered = true;
-                    }
-                }
-            }
+        PROFILE_END(PROFILE_LAYOUT);
+
+        // Send this frame's presses and taps over, each step takes at most one of each kind.
+        // Holding BACKSPACE scrubs back through the last 10 s (not while recording or replaying).
+        PROFILE_BEGIN(PROFILE_INPUT);
+        input.joystickCenter = joystickCenter;
+        input.joystickRadius = joystickRadius;
+        input.fireCenter = fireButtonCenter;
+        input.fireRadius = fireButtonRadius;
+        input.restartButton = hud.tryAgainButton;
+        input.restartEnabled = state->playerExploded;
+        PollInput(&input, GetTime());
+        SetSimulationEffects(&sim, settings.fireworkEvery, settings.particleBudget);
+        SendSimulationInput(&sim, &input, IsKeyDown(KEY_BACKSPACE));
+        PROFILE_END(PROFILE_INPUT);
+
+        // Idle once the game over screen is quiet, any input brings the full rate straight back
+        bool quiet = state->playerExploded && !state->replaying && state->particleCount <= idleMaxParticles &&
+                     !IsKeyDown(KEY_BACKSPACE) && GetTime() - input.lastActivity > idleDelay;
+        if (quiet != idle) {
+            idle = quiet;
+            SetTargetFPS(idle ? idleFrameRate : fullFrameRate);
         }
 
-        // Update joystick control
-        Vector2 joystickTouchPos = joystickCenter;
-        if (joystickTouchID != -1) {
-            Vector2 touchPos = GetTouchPositionByID(joystickTouchID);
-            if (touchPos.x != -1) {
-                float dx = touchPos.x - joystickCenter.x;
-                float dy = touchPos.y - joystickCenter.y;
-                float distance = sqrtf(dx * dx + dy * dy);
-
-                if (distance > joystickRadius) {
-                    dx = dx * joystickRadius / distance;
-                    dy = dy * joystickRadius / distance;
-                    distance = joystickRadius;
-                }
-
-                joystickTouchPos.x = joystickCenter.x + dx;
-                joystickTouchPos.y = joystickCenter.y + dy;
-
-                if (distance > joystickRadius * 0.2f) {
-                    float targetRotation = atan2f(dy, dx) * RAD2DEG;
-                    float angleDiff = ShortestAngle(player.rotation, targetRotation);
-                    float rotationSpeed = 5.0f;
-                    float rotationStep = fminf(fabsf(angleDiff), rotationSpeed) * (angleDiff > 0 ? 1.0f : -1.0f);
-                    player.rotation += rotationStep;
-                    player.rotation = fmodf(player.rotation, 360.0f);
-                    if (player.rotation < 0) player.rotation += 360.0f;
-                }
-
-                float normalizedDistance = distance / joystickRadius;
-                float targetSpeed = normalizedDistance * 5.0f;
-                float acceleration = 0.05f;
-                if (player.speed < targetSpeed) {
-                    player.speed += acceleration;
-                    if (player.speed > targetSpeed) player.speed = targetSpeed;
-                } else if (player.speed > targetSpeed) {
-                    player.speed -= acceleration;
-                    if (player.speed < targetSpeed) player.speed = targetSpeed;
-                }
-                player.speed = fmaxf(0.0f, fminf(player.speed, 5.0f));
-            } else {
-                joystickTouchID = -1;
-                player.speed -= 0.03f;
-                player.speed = fmaxf(0.0f, player.speed);
-            }
-        } else {
-            player.speed -= 0.03f;
-            player.speed = fmaxf(0.0f, player.speed);
+        // Newest state the simulation finished; builds without threads step here first.
+        // Presses come back before the state, so each one is in a state this frame can get.
+        UpdateSimulation(&sim);
+        ReceiveSimulationPresses(&sim, &input);
+        state = GetRenderState(&sim);
+        PROFILE_SIMULATION_STATE(state);
+
+        // How far the frame is between the state's step and the next one
+        float alpha = fminf(fmaxf((float)((GetTime() - state->time) / WORLD_DT), 0.0f), 1.0f);
+        float behind = (1.0f - alpha) * tickFrames;
+
+        // Refresh HUD regions whose title color, score or hover state changed, every
+        // hudInterval frames at lower quality; relayouts and game over show right away
+        PROFILE_BEGIN(PROFILE_HUD);
+        int colorIndex = (int)(state->worldTime * 2) % 5;
+        if (hud.dirty || state->playerExploded != hud.gameOver || hudFrames % settings.hudInterval == 0) {
+            UpdateHud(&hud, colorIndex, state->score, state->playerExploded, GetMousePosition());
         }
-
-        // Update fire button control
-        if (fireTouchID != -1) {
-            Vector2 touchPos = GetTouchPositionByID(fireTouchID);
-            if (touchPos.x == -1) {
-                fireTouchID = -1;
-            }
-        }
-
-        // Update previous touch count and IDs
-        prevTouchCount = touchCount;
-        for (int i = 0; i < touchCount; i++) {
-            prevTouchIDs[i] = currentTouchIDs[i];
-        }
-
-        // Game logic
-        if (!playerExploded) {
-            // Keyboard controls
-            if (IsKeyDown(KEY_RIGHT)) player.rotation += 5.0f;
-            if (IsKeyDown(KEY_LEFT)) player.rotation -= 5.0f;
-            if (IsKeyDown(KEY_UP)) player.speed += 0.1f;
-            if (IsKeyDown(KEY_DOWN)) player.speed -= 0.1f;
-            player.speed = fmaxf(0.0f, fminf(player.speed, 5.0f));
-
-            // Player movement
-            float rad = player.rotation * DEG2RAD;
-            player.position.x += player.speed * cosf(rad);
-            player.position.y += player.speed * sinf(rad);
-            player.position.x = (player.position.x > screenWidth) ? 0 : (player.position.x < 0) ? screenWidth : player.position.x;
-            player.position.y = (player.position.y > screenHeight) ? 0 : (player.position.y < 0) ? screenHeight : player.position.y;
-
-            // Shoot lasers
-            if (fireTriggered || IsKeyPressed(KEY_SPACE)) {
-                for (int i = 0; i < MAX_LASERS; i++) {
-                    if (!lasers[i].active) {
-                        lasers[i].position = (Vector2){player.position.x + laserLength * cosf(rad), player.position.y + laserLength * sinf(rad)};
-                        lasers[i].rotation = player.rotation;
-                        lasers[i].speed = 10.0f;
-                        lasers[i].active = true;
-                        break;
-                    }
-                }
-                fireTriggered = false;
-            }
-
-            // Update lasers
-            for (int i = 0; i < MAX_LASERS; i++) {
-                if (lasers[i].active) {
-                    float laserRad = lasers[i].rotation * DEG2RAD;
-                    lasers[i].position.x += lasers[i].speed * cosf(laserRad);
-                    lasers[i].position.y += lasers[i].speed * sinf(laserRad);
-                    if (lasers[i].position.x < 0 || lasers[i].position.x > screenWidth ||
-                        lasers[i].position.y < 0 || lasers[i].position.y > screenHeight) {
-                        lasers[i].active = false;
-                    }
-                }
-            }
-
-            // Spawn enemies periodically
-            static float enemySpawnTimer = 0.0f;
-            enemySpawnTimer += GetFrameTime();
-            if (enemySpawnTimer > 2.0f) {
-                for (int i = 0; i < MAX_ENEMIES; i++) {
-                    if (!enemies[i].active) {
-                        enemies[i].position.x = rand() % screenWidth;
-                        enemies[i].position.y = rand() % screenHeight;
-                        enemies[i].speed = 2.0f;
-                        enemies[i].active = true;
-                        break;
-                    }
-                }
-                enemySpawnTimer = 0.0f;
-            }
-
-            // Update enemy movement towards player
-            for (int i = 0; i < MAX_ENEMIES; i++) {
-                if (enemies[i].active) {
-                    Vector2 direction = {player.position.x - enemies[i].position.x, player.position.y - enemies[i].position.y};
-                    float length = sqrtf(direction.x * direction.x + direction.y * direction.y);
-                    if (length > 0) {
-                        direction.x /= length;
-                        direction.y /= length;
-                    }
-                    enemies[i].position.x += direction.x * enemies[i].speed;
-                    enemies[i].position.y += direction.y * enemies[i].speed;
-                }
-            }
-
-            // Check collisions between lasers and enemies
-            for (int i = 0; i < MAX_LASERS; i++) {
-                if (lasers[i].active) {
-                    for (int j = 0; j < MAX_ENEMIES; j++) {
-                        if (enemies[j].active) {
-                            if (CheckCollisionPointCircle(lasers[i].position, enemies[j].position, enemyRadius)) {
-                                lasers[i].active = false;
-                                enemies[j].active = false;
-                                score++;
-                                for (int k = 0; k < 10; k++) {
-                                    int p = rand() % MAX_PARTICLES;
-                                    if (particles[p].life <= 0) {
-                                        particles[p].position = enemies[j].position;
-                                        float angle = rand() % 360 * DEG2RAD;
-                                        float speed = (rand() % 5) + 1;
-                                        particles[p].velocity = (Vector2){speed * cosf(angle), speed * sinf(angle)};
-                                        particles[p].color = YELLOW;
-                                        particles[p].alpha = 1.0f;
-                                        particles[p].life = 1.0f;
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-
-            // Check collision between player and enemies
-            for (int i = 0; i < MAX_ENEMIES; i++) {
-                if (enemies[i].active) {
-                    if (CheckCollisionCircles(player.position, shipSize / 2, enemies[i].position, enemyRadius)) {
-                        playerExploded = true;
-                        for (int k = 0; k < 20; k++) {
-                            int p = rand() % MAX_PARTICLES;
-                            if (particles[p].life <= 0) {
-                                particles[p].position = player.position;
-                                float angle = rand() % 360 * DEG2RAD;
-                                float speed = (rand() % 5) + 1;
-                                particles[p].velocity = (Vector2){speed * cosf(angle), speed * sinf(angle)};
-                                particles[p].color = RED;
-                                particles[p].alpha = 1.0f;
-                                particles[p].life = 1.0f;
-                            }
-                        }
-                    }
-                }
-            }
-        }
-
-        // Handle "Try Again" button and Tab key
-        if (playerExploded) {
-            bool isTryAgainHovered = CheckCollisionPointRec(GetMousePosition(), tryAgainButton);
-            if ((isTryAgainHovered && IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) || IsKeyPressed(KEY_TAB)) {
-                player.position = (Vector2){screenWidth / 2.0f, screenHeight / 2.0f};
-                player.rotation = 0.0f;
-                player.speed = 0.0f;
-                for (int i = 0; i < MAX_LASERS; i++) lasers[i].active = false;
-                for (int i = 0; i < MAX_ENEMIES; i++) enemies[i].active = false;
-                score = 0;
-                playerExploded = false;
-            }
-        }
-
-        // Update particles
-        for (int i = 0; i < MAX_PARTICLES; i++) {
-            if (particles[i].life > 0) {
-                particles[i].position.x += particles[i].velocity.x;
-                particles[i].position.y += particles[i].velocity.y;
-                particles[i].alpha -= 0.01f;
-                particles[i].life -= 0.01f;
-                if (particles[i].alpha < 0) particles[i].alpha = 0;
-            }
-        }
-
-        // Create background firework effect
-        static float fireworkTimer = 0.0f;
-        fireworkTimer += GetFrameTime();
-        if (fireworkTimer > 0.1f) {
-            for (int i = 0; i < MAX_PARTICLES; i++) {
-                if (particles[i].life <= 0) {
-                    particles[i].position = (Vector2){rand() % screenWidth, rand() % screenHeight};
-                    float angle = rand() % 360 * DEG2RAD;
-                    float speed = (rand() % 5) + 1;
-                    particles[i].velocity = (Vector2){speed * cosf(angle), speed * sinf(angle)};
-                    particles[i].color = WHITE;
-                    particles[i].alpha = 1.0f;
-                    particles[i].life = 1.0f;
-                    break;
-                }
-            }
-            fireworkTimer = 0.0f;
+        hudFrames++;
+        if (CheckCollisionPointRec(GetMousePosition(), hud.buttonRect) && IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
+            OpenURL("https://x.com/kirbara2000");
         }
+        PROFILE_END(PROFILE_HUD);
 
         // Draw directly to screen
+        PROFILE_BEGIN(PROFILE_DRAW);
         BeginDrawing();
         ClearBackground(BLACK);
 
-        // Draw fireworks and explosion particles
-        for (int i = 0; i < MAX_PARTICLES; i++) {
-            if (particles[i].life > 0) {
-                DrawPixelV(particles[i].position, Fade(particles[i].color, particles[i].alpha));
-            }
+        BeginSpriteBatch(&batch);
+        BeginViewport(&viewport);
+
+        // Draw fireworks and explosion particles, stepped back along their velocity
+        for (int i = 0; i < state->particleCount; i++) {
+            Vector2 position = {state->x[i] - state->vx[i] * behind, state->y[i] - state->vy[i] * behind};
+            PushSpritePixel(&batch, position, Fade(state->color[i], state->alpha[i]));
         }
+        FlushSpriteLayer(&batch);
 
         // Draw player spaceship if not exploded
-        if (!playerExploded) {
-            float rad = player.rotation * DEG2RAD;
-            Vector2 front = {player.position.x + shipSize * cosf(rad), player.position.y + shipSize * sinf(rad)};
-            Vector2 backLeft = {player.position.x - shipSize * 0.5f * cosf(rad) + shipSize * 0.5f * sinf(rad), player.position.y - shipSize * 0.5f * sinf(rad) - shipSize * 0.5f * cosf(rad)};
-            Vector2 backRight = {player.position.x - shipSize * 0.5f * cosf(rad) - shipSize * 0.5f * sinf(rad), player.position.y - shipSize * 0.5f * sinf(rad) + shipSize * 0.5f * cosf(rad)};
-            DrawTriangle(front, backLeft, backRight, WHITE);
+        if (!state->playerExploded) {
+            Spaceship player = state->player;
+            player.position = LerpPosition(player.prevPosition, player.position, alpha);
+            player.rotation = LerpAngle(player.prevRotation, player.rotation, alpha);
+            Vector2 dir;
+            FastDirection(player.rotation, &dir.x, &dir.y);
+            Vector2 front = {player.position.x + SHIP_SIZE * dir.x, player.position.y + SHIP_SIZE * dir.y};
+            Vector2 backLeft = {player.position.x - SHIP_SIZE * 0.5f * dir.x + SHIP_SIZE * 0.5f * dir.y, player.position.y - SHIP_SIZE * 0.5f * dir.y - SHIP_SIZE * 0.5f * dir.x};
+            Vector2 backRight = {player.position.x - SHIP_SIZE * 0.5f * dir.x - SHIP_SIZE * 0.5f * dir.y, player.position.y - SHIP_SIZE * 0.5f * dir.y + SHIP_SIZE * 0.5f * dir.x};
+            PushSpriteTriangle(&batch, front, backLeft, backRight, WHITE);
+            FlushSpriteLayer(&batch);
         }
 
-        // Draw active lasers
-        for (int i = 0; i < MAX_LASERS; i++) {
-            if (lasers[i].active) {
-                float laserRad = lasers[i].rotation * DEG2RAD;
-                Vector2 end = {lasers[i].position.x + laserLength * cosf(laserRad), lasers[i].position.y + laserLength * sinf(laserRad)};
-                DrawLineV(lasers[i].position, end, YELLOW);
-            }
+        // Draw lasers
+        for (int i = 0; i < state->laserCount; i++) {
+            Vector2 dir = state->lasers[i].direction;
+            float back = state->lasers[i].speed * behind;
+            Vector2 start = {state->lasers[i].position.x - back * dir.x, state->lasers[i].position.y - back * dir.y};
+            Vector2 end = {start.x + LASER_LENGTH * dir.x, start.y + LASER_LENGTH * dir.y};
+            PushSpriteLine(&batch, start, end, 1.0f, YELLOW);
         }
+        FlushSpriteLayer(&batch);
 
-        // Draw active enemies
-        for (int i = 0; i < MAX_ENEMIES; i++) {
-            if (enemies[i].active) {
-                DrawCircleV(enemies[i].position, enemyRadius, RED);
-            }
+        // Draw enemies, the state only holds living ones
+        for (int i = 0; i < state->enemyCount; i++) {
+            Vector2 position = LerpPosition(state->enemies[i].prevPosition, state->enemies[i].position, alpha);
+            PushSpriteCircle(&batch, position, ENEMY_RADIUS, RED);
         }
+        FlushSpriteLayer(&batch);
+        EndViewport(&viewport);
 
         // Draw UI
-        static float timer = 0.0f;
-        timer += GetFrameTime();
-        Color colors[] = {BLUE, RED, GREEN, WHITE, MAGENTA};
-        int colorIndex = (int)(timer * 2) % 5;
-        DrawText(titleText, titleX, titleY, fontSize, colors[colorIndex]);
-
-        DrawText(subText, subX, subY, fontSize / 2, WHITE);
-        DrawText(controlText, controlX, controlY, fontSize / 2, Fade(WHITE, 0.5f));
-
-        bool isButtonHovered = CheckCollisionPointRec(GetMousePosition(), buttonRect);
-        Color buttonColor = isButtonHovered ? YELLOW : WHITE;
-        DrawRectangleRec(buttonRect, buttonColor);
-        int buttonTextWidth = MeasureText("X kirbara2000", fixedFontSizeSocial);
-        int buttonTextX = buttonRect.x + (buttonRect.width - buttonTextWidth) / 2;
-        int buttonTextY = buttonRect.y + (buttonRect.height - fixedFontSizeSocial) / 2;
-        DrawText("X kirbara2000", buttonTextX, buttonTextY, fixedFontSizeSocial, BLACK);
-        if (isButtonHovered && IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-            OpenURL("https://x.com/kirbara2000");
-        }
-
-        if (!playerExploded) {
-            char scoreText[32];
-            sprintf(scoreText, "Score: %d", score);
-            int scoreWidth = MeasureText(scoreText, fontSize);
-            DrawText(scoreText, (screenWidth - scoreWidth) / 2, scoreY, fontSize, YELLOW);
-        } else {
-            char gameOverText[64];
-            sprintf(gameOverText, "IT'S SO OVER. TOTAL: %d", score);
-            int gameOverWidth = MeasureText(gameOverText, fontSize);
-            DrawText(gameOverText, (screenWidth - gameOverWidth) / 2, scoreY, fontSize, YELLOW);
-
-            // Draw "Nah, I'd Win" button
-            bool isTryAgainHovered = CheckCollisionPointRec(GetMousePosition(), tryAgainButton);
-            Color tryAgainColor = isTryAgainHovered ? YELLOW : WHITE;
-            DrawRectangleRec(tryAgainButton, tryAgainColor);
-            int tryAgainTextWidth = MeasureText("Nah, I'd Win", fixedFontSizeTryAgain);
-            int tryAgainTextX = tryAgainButton.x + (tryAgainButton.width - tryAgainTextWidth) / 2;
-            int tryAgainTextY = tryAgainButton.y + (tryAgainButton.height - fixedFontSizeTryAgain) / 2;
-            DrawText("Nah, I'd Win", tryAgainTextX, tryAgainTextY, fixedFontSizeTryAgain, BLACK);
-
-            // Draw "press TAB" text
-            const char* pressTabText = "press TAB";
-            int pressTabFontSize = fixedFontSizeTryAgain / 2; // Smaller font size
-            int pressTabWidth = MeasureText(pressTabText, pressTabFontSize);
-            int pressTabX = tryAgainButton.x + (tryAgainButton.width - pressTabWidth) / 2;
-            int pressTabY = tryAgainButton.y + tryAgainButton.height + 10; // 10 pixels below button
-            DrawText(pressTabText, pressTabX, pressTabY, pressTabFontSize, Fade(WHITE, 0.5f));
-        }
-
-        DrawText(bottomTextLine1, bottomXLine1, bottomYLine1, fontSize / 2, Fade(WHITE, 0.5f));
-        DrawText(bottomTextLine2, bottomXLine2, bottomYLine2, fontSize / 2, Fade(WHITE, 0.5f));
+        DrawHud(&hud);
 
         // Draw touch controls
-        DrawCircleV(joystickCenter, joystickRadius, Fade(WHITE, 0.2f));
-        if (joystickTouchID != -1) {
-            DrawCircleV(joystickTouchPos, 10, Fade(WHITE, 0.5f));
+        PushSpriteCircle(&batch, joystickCenter, joystickRadius, Fade(WHITE, 0.2f));
+        if (input.joystick) {
+            PushSpriteCircle(&batch, input.joystickPosition, 10, Fade(WHITE, 0.5f));
         }
-        DrawCircleV(fireButtonCenter, fireButtonRadius, Fade(RED, 0.2f));
+        PushSpriteCircle(&batch, fireButtonCenter, fireButtonRadius, Fade(RED, 0.2f));
 
         // Draw custom mouse cursor
         Vector2 mousePos = GetMousePosition();
-        DrawCircleV(mousePos, 5.0f, BLUE);
+        PushSpriteCircle(&batch, mousePos, 5.0f, BLUE);
+        FlushSpriteLayer(&batch);
+
+        // Draw call report, F3 toggles; raylib's own text batch adds one more per flush. Lines
+        // stack from the top, the profiler overlay goes below the last one.
+        if (IsKeyPressed(KEY_F3)) showStats = !showStats;
+        int overlayY = 30;
+        if (showStats) {
+            int lineY = 10;
+            DrawText(TextFormat("sprite draw calls: %d, sprites: %d, hud redraws: %d", batch.drawCalls, batch.sprites, hud.redraws), 10, lineY, 10, LIME);
+            lineY += 10;
+            DrawText(TextFormat("%d fps%s, busy %.1f%% of wall time", framesPerSecond, idle ? " (idle)" : "", busyPercent), 10, lineY, 10, LIME);
+            lineY += 10;
+            float latencyP50, latencyP99;
+            if (GetInputLatency(&input, &latencyP50, &latencyP99)) {
+                DrawText(TextFormat("input to present: p50 %.1f ms, p99 %.1f ms", latencyP50, latencyP99), 10, lineY, 10, LIME);
+                lineY += 10;
+            }
+            DrawText(TextFormat("rewind: %.1f s in %d KB", state->rewindSeconds, state->rewindBytes / 1024), 10, lineY, 10, LIME);
+            lineY += 10;
+            QualityStats qualityStats = GetQualityStats(&quality);
+            DrawText(TextFormat("quality %d/%d: frame %.1f ms, busy %.1f ms of %.1f, lowered %d, raised %d", qualityStats.level,
+                                QUALITY_LEVELS - 1, qualityStats.frameTime, qualityStats.busyTime, qualityStats.budget,
+                                qualityStats.lowered, qualityStats.raised), 10, lineY, 10, LIME);
+            lineY += 10;
+            overlayY = lineY + 10;
+        }
+        (void)overlayY;     // Only read by the profiler overlay, which release builds compile out
+        PROFILE_COUNTER(PROFILE_DRAW_CALLS, batch.drawCalls);
+        PROFILE_COUNTER(PROFILE_SPRITES, batch.sprites);
+
+#if defined(PROFILER_ENABLED)
+        // Profiler overlay on F4, F5 writes the last PROFILE_FRAMES frames to profile.csv
+        if (IsKeyPressed(KEY_F4)) showProfiler = !showProfiler;
+        if (IsKeyPressed(KEY_F5)) {
+            if (ExportProfile("profile.csv")) TraceLog(LOG_INFO, "PROFILER: Saved profile.csv");
+            else TraceLog(LOG_WARNING, "PROFILER: Failed to save profile.csv");
+        }
+        if (showProfiler) DrawProfiler(10, overlayY);
+#endif
+        PROFILE_END(PROFILE_DRAW);
+
+        // Busy time ends where the frame cap wait starts, inside EndDrawing after the swap
+        double frameBusy = GetTime() - frameStart;
+        busyTime += frameBusy;
+        busyFrames++;
+        if (!paced) UpdateQuality(&quality, (float)frameInterval, (float)frameBusy);
+        if (GetTime() - busyWindowStart >= 1.0) {
+            double window = GetTime() - busyWindowStart;
+            busyPercent = (float)(100.0 * busyTime / window);
+            framesPerSecond = (int)(busyFrames / window + 0.5);
+            busyTime = 0.0;
+            busyFrames = 0;
+            busyWindowStart = GetTime();
+        }
 
+        PROFILE_BEGIN(PROFILE_PRESENT);
         EndDrawing();
+        PROFILE_END(PROFILE_PRESENT);
+
+        // Time to first frame, once: from navigation start on the web (download, compile and
+        // init included), from InitWindow natively
+        if (!presented) {
+            presented = true;
+#if defined(__EMSCRIPTEN__)
+            TraceLog(LOG_INFO, "STARTUP: first frame after %.1f ms", emscripten_get_now());
+#else
+            TraceLog(LOG_INFO, "STARTUP: first frame after %.1f ms", GetTime() * 1000.0);
+#endif
+        }
+        float latency = EndInputFrame(&input, GetTime());
+        (void)latency;      // Read by the profiler only, compiled out with NDEBUG
+        PROFILE_COUNTER(PROFILE_INPUT_LATENCY, (int)(latency * 1000.0f));
+        PROFILE_FRAME_END();
     }
 
+    StopSimulation(&sim);
+    if (recording && !SaveRecording(&session, recordPath)) TraceLog(LOG_WARNING, "REPLAY: Failed to save %s", recordPath);
+    UnloadRecording(&session);
+    UnloadWorld(&world);
+    UnloadSpriteBatch(&batch);
+    UnloadHud(&hud);
     CloseWindow();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,189 @@
+#include "input.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+void InitInput(InputState *input) {
+    memset(input, 0, sizeof(*input));
+    for (int i = 0; i < INPUT_TOUCH_SLOTS; i++) input->touches[i].id = -1;
+    input->joystickId = -1;
+}
+
+void PushInputEvent(InputState *input, InputAction action, double time) {
+    if (input->count == INPUT_QUEUE_SIZE) {
+        input->dropped++;
+        return;
+    }
+    input->events[(input->head + input->count) & (INPUT_QUEUE_SIZE - 1)] = (InputEvent){action, time};
+    input->count++;
+}
+
+// Linear probing from the id's home slot, the map is never more than half full
+static int FindTouchSlot(const InputState *input, int id) {
+    int slot = (unsigned int)id & (INPUT_TOUCH_SLOTS - 1);
+    while (input->touches[slot].id != -1) {
+        if (input->touches[slot].id == id) return slot;
+        slot = (slot + 1) & (INPUT_TOUCH_SLOTS - 1);
+    }
+    return -1;
+}
+
+static TouchSlot *AddTouch(InputState *input, int id) {
+    int slot = (unsigned int)id & (INPUT_TOUCH_SLOTS - 1);
+    while (input->touches[slot].id != -1) slot = (slot + 1) & (INPUT_TOUCH_SLOTS - 1);
+    input->touches[slot] = (TouchSlot){.id = id, .role = TOUCH_FREE};
+    input->touchCount++;
+    return &input->touches[slot];
+}
+
+// Backward shift delete: pull later entries of the probe run into the hole so lookups
+// never stop early at it
+static void RemoveTouch(InputState *input, int slot) {
+    int hole = slot;
+    int next = (hole + 1) & (INPUT_TOUCH_SLOTS - 1);
+    while (input->touches[next].id != -1) {
+        int home = (unsigned int)input->touches[next].id & (INPUT_TOUCH_SLOTS - 1);
+        // Move the entry unless its home lies cyclically in (hole, next]
+        if (((next - home) & (INPUT_TOUCH_SLOTS - 1)) >= ((next - hole) & (INPUT_TOUCH_SLOTS - 1))) {
+            input->touches[hole] = input->touches[next];
+            hole = next;
+        }
+        next = (next + 1) & (INPUT_TOUCH_SLOTS - 1);
+    }
+    input->touches[hole].id = -1;
+    input->touchCount--;
+}
+
+const TouchSlot *GetTouch(const InputState *input, int id) {
+    int slot = FindTouchSlot(input, id);
+    return (slot < 0) ? NULL : &input->touches[slot];
+}
+
+static void PollTouches(InputState *input, double now) {
+    unsigned int poll = ++input->poll;
+    int count = GetTouchPointCount();
+    for (int i = 0; i < count && i < INPUT_TOUCH_SLOTS / 2; i++) {
+        int id = GetTouchPointId(i);
+        int slot = FindTouchSlot(input, id);
+        TouchSlot *touch = (slot < 0) ? AddTouch(input, id) : &input->touches[slot];
+        touch->position = GetTouchPosition(i);
+        touch->seen = poll;
+        if (slot >= 0) continue;
+
+        // New touch: it belongs to whichever control it started on for as long as it is down
+        if (CheckCollisionPointCircle(touch->position, input->joystickCenter, input->joystickRadius)) {
+            if (input->joystickId == -1) {
+                touch->role = TOUCH_JOYSTICK;
+                input->joystickId = id;
+            }
+        } else if (CheckCollisionPointCircle(touch->position, input->fireCenter, input->fireRadius)) {
+            touch->role = TOUCH_FIRE;
+            PushInputEvent(input, INPUT_FIRE, now);
+        }
+    }
+
+    // Released touches are the ones this poll did not report. A removal can shift a later
+    // entry back into the slot just checked, so look at it again.
+    for (int slot = 0; slot < INPUT_TOUCH_SLOTS && input->touchCount > 0; slot++) {
+        TouchSlot *touch = &input->touches[slot];
+        if (touch->id == -1 || touch->seen == poll) continue;
+        if (touch->id == input->joystickId) input->joystickId = -1;
+        RemoveTouch(input, slot);
+        slot--;
+    }
+}
+
+void PollInput(InputState *input, double now) {
+    // raylib queues every key press since the last frame, so repeated presses all arrive
+    bool active = false;
+    for (int key = GetKeyPressed(); key != 0; key = GetKeyPressed()) {
+        active = true;
+        if (key == KEY_SPACE) PushInputEvent(input, INPUT_FIRE, now);
+        else if (key == KEY_TAB && input->restartEnabled) PushInputEvent(input, INPUT_RESTART, now);
+    }
+    if (input->restartEnabled && IsMouseButtonPressed(MOUSE_LEFT_BUTTON) &&
+        CheckCollisionPointRec(GetMousePosition(), input->restartButton)) {
+        PushInputEvent(input, INPUT_RESTART, now);
+    }
+
+    PollTouches(input, now);
+
+    input->right = IsKeyDown(KEY_RIGHT);
+    input->left = IsKeyDown(KEY_LEFT);
+    input->up = IsKeyDown(KEY_UP);
+    input->down = IsKeyDown(KEY_DOWN);
+
+    // Anything the player does counts, including hovering the buttons and function keys
+    Vector2 mouseDelta = GetMouseDelta();
+    active = active || input->left || input->right || input->up || input->down || input->touchCount > 0 ||
+             mouseDelta.x != 0.0f || mouseDelta.y != 0.0f || GetMouseWheelMove() != 0.0f ||
+             IsMouseButtonDown(MOUSE_LEFT_BUTTON) || IsMouseButtonDown(MOUSE_RIGHT_BUTTON);
+    if (active) input->lastActivity = now;
+
+    // Joystick follows its touch, clamped to the base
+    input->joystick = false;
+    input->stick = (Vector2){0.0f, 0.0f};
+    input->joystickPosition = input->joystickCenter;
+    const TouchSlot *touch = (input->joystickId != -1) ? GetTouch(input, input->joystickId) : NULL;
+    if (touch) {
+        float dx = touch->position.x - input->joystickCenter.x;
+        float dy = touch->position.y - input->joystickCenter.y;
+        float distance = sqrtf(dx * dx + dy * dy);
+        if (distance > input->joystickRadius) {
+            dx = dx * input->joystickRadius / distance;
+            dy = dy * input->joystickRadius / distance;
+        }
+        input->joystick = true;
+        input->stick = (Vector2){dx / input->joystickRadius, dy / input->joystickRadius};
+        input->joystickPosition = (Vector2){input->joystickCenter.x + dx, input->joystickCenter.y + dy};
+    }
+}
+
+void TakeStepInputs(InputState *input, GameInputs *inputs) {
+    memset(inputs, 0, sizeof(*inputs));
+    inputs->left = input->left;
+    inputs->right = input->right;
+    inputs->up = input->up;
+    inputs->down = input->down;
+    inputs->joystick = input->joystick;
+    inputs->stick = input->stick;
+
+    // Take presses in order until one repeats an action this step already has
+    while (input->count > 0) {
+        const InputEvent *event = &input->events[input->head];
+        bool *pressed = (event->action == INPUT_FIRE) ? &inputs->fire : &inputs->restart;
+        if (*pressed) break;
+        *pressed = true;
+        if (input->appliedCount < INPUT_QUEUE_SIZE) input->applied[input->appliedCount++] = event->time;
+        input->head = (input->head + 1) & (INPUT_QUEUE_SIZE - 1);
+        input->count--;
+    }
+}
+
+float EndInputFrame(InputState *input, double now) {
+    float oldest = 0.0f;
+    for (int i = 0; i < input->appliedCount; i++) {
+        float ms = (float)(1000.0 * (now - input->applied[i]));
+        oldest = fmaxf(oldest, ms);
+        input->latency[input->latencyHead] = ms;
+        input->latencyHead = (input->latencyHead + 1) % INPUT_LATENCY_SAMPLES;
+        if (input->latencyCount < INPUT_LATENCY_SAMPLES) input->latencyCount++;
+    }
+    input->appliedCount = 0;
+    return oldest;
+}
+
+static int CompareFloat(const void *a, const void *b) {
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+bool GetInputLatency(const InputState *input, float *p50, float *p99) {
+    if (input->latencyCount == 0) return false;
+    float samples[INPUT_LATENCY_SAMPLES];
+    memcpy(samples, input->latency, sizeof(float) * input->latencyCount);
+    qsort(samples, input->latencyCount, sizeof(float), CompareFloat);
+    *p50 = samples[(input->latencyCount - 1) / 2];
+    *p99 = samples[(input->latencyCount - 1) * 99 / 100];
+    return true;
+}
@@ -0,0 +1,86 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include "raylib.h"
+#include "world.h"
+
+// Frontend input layer. Presses and taps become timestamped events in a queue, and every
+// simulation step takes at most one press of each kind from it, oldest first, so presses
+// that land in the same frame fire on consecutive steps instead of collapsing into one.
+// Touches live in a small open addressing map keyed by touch id: lookups, new touch
+// detection and release are O(1) per touch point instead of rescanning the previous frame.
+//
+// raylib hands over input once per frame (PollInputEvents in EndDrawing), so an event's
+// time is the poll that saw it; the press itself happened up to one frame before that.
+#define INPUT_QUEUE_SIZE 64         // Power of two, presses past this are dropped and counted
+#define INPUT_TOUCH_SLOTS 16        // Power of two, twice raylib's MAX_TOUCH_POINTS
+#define INPUT_LATENCY_SAMPLES 240
+
+typedef enum {
+    INPUT_FIRE = 0,         // SPACE or a new touch on the fire button
+    INPUT_RESTART,          // TAB or a click on "Nah, I'd Win" while game over
+} InputAction;
+
+typedef struct {
+    InputAction action;
+    double time;            // GetTime() of the poll that saw it
+} InputEvent;
+
+typedef enum {
+    TOUCH_FREE = 0,         // Touch that hit no control
+    TOUCH_JOYSTICK,
+    TOUCH_FIRE,
+} TouchRole;
+
+typedef struct {
+    int id;                 // raylib touch point id, -1 when the slot is empty
+    TouchRole role;
+    Vector2 position;       // Latest position, screen space
+    unsigned int seen;      // Poll that last reported it
+} TouchSlot;
+
+typedef struct {
+    // Control layout in screen space, set by the frontend before each poll
+    Vector2 joystickCenter;
+    float joystickRadius;
+    Vector2 fireCenter;
+    float fireRadius;
+    Rectangle restartButton;
+    bool restartEnabled;            // Restart presses only count on the game over screen
+
+    // Pending presses, a ring buffer
+    InputEvent events[INPUT_QUEUE_SIZE];
+    int head;
+    int count;
+    int dropped;                    // Presses lost to a full queue
+
+    // Touches currently down
+    TouchSlot touches[INPUT_TOUCH_SLOTS];
+    int touchCount;
+    unsigned int poll;
+    int joystickId;                 // Touch holding the joystick, -1 when none
+
+    // Held state, refreshed every poll
+    bool left, right, up, down;
+    bool joystick;
+    Vector2 stick;                  // Joystick offset scaled so length <= 1
+    Vector2 joystickPosition;       // Knob position on screen
+    double lastActivity;            // Poll time of the last key, mouse or touch activity
+
+    // Input to photon latency: poll time of every press applied since the last present
+    double applied[INPUT_QUEUE_SIZE];
+    int appliedCount;
+    float latency[INPUT_LATENCY_SAMPLES];   // Milliseconds, ring buffer
+    int latencyHead;
+    int latencyCount;
+} InputState;
+
+void InitInput(InputState *input);
+void PollInput(InputState *input, double now);     // Queue this frame's presses and taps, refresh held state
+void PushInputEvent(InputState *input, InputAction action, double time);      // Queue a press, counted in dropped when full
+void TakeStepInputs(InputState *input, GameInputs *inputs);    // Held state plus the oldest queued press of each kind
+float EndInputFrame(InputState *input, double now);    // After EndDrawing: presses applied this frame are on screen, returns the oldest one's latency in ms or 0
+const TouchSlot *GetTouch(const InputState *input, int id);    // NULL when the touch is not down
+bool GetInputLatency(const InputState *input, float *p50, float *p99);     // Milliseconds, false before the first press
+
+#endif // INPUT_H
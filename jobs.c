@@ -0,0 +1,199 @@
+#define _POSIX_C_SOURCE 200809L  // sysconf
+#include "jobs.h"
+#include <stdlib.h>
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+int GetCpuCount(void) {
+#if defined(_WIN32)
+    const char *env = getenv("NUMBER_OF_PROCESSORS");
+    int count = env ? atoi(env) : 1;
+#else
+    int count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return (count > 0) ? count : 1;
+}
+
+#if defined(JOBS_SINGLE_THREADED)
+
+void InitJobs(int workerCount) { (void)workerCount; }
+void CloseJobs(void) { }
+int GetJobWorkerCount(void) { return 0; }
+
+void ParallelFor(int count, int grain, JobRangeFunc func, void *data) {
+    (void)grain;
+    if (count > 0) func(data, 0, count);
+}
+
+#else
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+#define MAX_JOB_WORKERS 63
+#define JOB_DEQUE_SIZE 256          // Halving keeps occupancy near log2(count / grain), far below this
+
+// Chase-Lev deque of ranges packed as begin << 32 | end, so slots can be read atomically
+typedef struct {
+    atomic_llong top;               // Thieves take from here
+    atomic_llong bottom;            // Owner pushes and pops here
+    atomic_ullong ranges[JOB_DEQUE_SIZE];
+    char pad[64];                   // Keep neighbouring deques off the same cache line
+} JobDeque;
+
+static struct {
+    int workerCount;
+    pthread_t threads[MAX_JOB_WORKERS];
+    JobDeque deques[MAX_JOB_WORKERS + 1];   // [0] belongs to the submitting thread
+    pthread_t owner;
+    pthread_mutex_t mutex;
+    pthread_cond_t wake;
+    unsigned long generation;               // Bumped for every ParallelFor, wakes the workers
+    bool quit;
+    bool initialized;                       // Mutex and condition variable exist, even with no workers
+
+    // Loop being run, written before its first range is pushed
+    JobRangeFunc func;
+    void *data;
+    int grain;
+    atomic_int remaining;                   // Items not finished yet
+} jobs;
+
+static unsigned long long PackRange(int begin, int end) {
+    return ((unsigned long long)(unsigned int)begin << 32) | (unsigned int)end;
+}
+
+static bool PushRange(JobDeque *d, int begin, int end) {
+    long long b = atomic_load_explicit(&d->bottom, memory_order_relaxed);
+    long long t = atomic_load_explicit(&d->top, memory_order_acquire);
+    if (b - t >= JOB_DEQUE_SIZE) return false;
+    atomic_store_explicit(&d->ranges[b & (JOB_DEQUE_SIZE - 1)], PackRange(begin, end), memory_order_relaxed);
+    atomic_store_explicit(&d->bottom, b + 1, memory_order_release);
+    return true;
+}
+
+static bool PopRange(JobDeque *d, unsigned long long *range) {
+    long long b = atomic_load_explicit(&d->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&d->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long t = atomic_load_explicit(&d->top, memory_order_relaxed);
+    if (t > b) {
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+        return false;
+    }
+    *range = atomic_load_explicit(&d->ranges[b & (JOB_DEQUE_SIZE - 1)], memory_order_relaxed);
+    if (t == b) {
+        // Last item, race any thief for it
+        bool won = atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed);
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+        return won;
+    }
+    return true;
+}
+
+static bool StealRange(JobDeque *d, unsigned long long *range) {
+    long long t = atomic_load_explicit(&d->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long b = atomic_load_explicit(&d->bottom, memory_order_acquire);
+    if (t >= b) return false;
+    *range = atomic_load_explicit(&d->ranges[t & (JOB_DEQUE_SIZE - 1)], memory_order_relaxed);
+    return atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed);
+}
+
+// Split off the upper half for thieves until the range is grain sized, then run it
+static void ExecuteRange(int self, int begin, int end) {
+    while (end - begin > jobs.grain) {
+        int mid = begin + (end - begin) / 2;
+        if (!PushRange(&jobs.deques[self], mid, end)) break;
+        end = mid;
+    }
+    jobs.func(jobs.data, begin, end);
+    atomic_fetch_sub_explicit(&jobs.remaining, end - begin, memory_order_acq_rel);
+}
+
+static void RunUntilDone(int self) {
+    int threads = jobs.workerCount + 1;
+    while (atomic_load_explicit(&jobs.remaining, memory_order_acquire) > 0) {
+        unsigned long long range;
+        bool found = PopRange(&jobs.deques[self], &range);
+        for (int k = 1; !found && k < threads; k++) {
+            found = StealRange(&jobs.deques[(self + k) % threads], &range);
+        }
+        if (found) ExecuteRange(self, (int)(range >> 32), (int)(range & 0xffffffffu));
+        else sched_yield();
+    }
+}
+
+static void *JobWorker(void *arg) {
+    int self = (int)(intptr_t)arg;
+    unsigned long seen = 0;
+    for (;;) {
+        pthread_mutex_lock(&jobs.mutex);
+        while (jobs.generation == seen && !jobs.quit) pthread_cond_wait(&jobs.wake, &jobs.mutex);
+        bool quit = jobs.quit;
+        seen = jobs.generation;
+        pthread_mutex_unlock(&jobs.mutex);
+        if (quit) break;
+        RunUntilDone(self);
+    }
+    return NULL;
+}
+
+void InitJobs(int workerCount) {
+    if (workerCount > MAX_JOB_WORKERS) workerCount = MAX_JOB_WORKERS;
+    if (workerCount < 0) workerCount = 0;
+    pthread_mutex_init(&jobs.mutex, NULL);
+    pthread_cond_init(&jobs.wake, NULL);
+    jobs.initialized = true;
+    jobs.owner = pthread_self();
+    jobs.quit = false;
+    jobs.workerCount = 0;
+    for (int i = 0; i < workerCount; i++) {
+        if (pthread_create(&jobs.threads[i], NULL, JobWorker, (void *)(intptr_t)(i + 1)) != 0) break;
+        jobs.workerCount++;
+    }
+}
+
+void CloseJobs(void) {
+    if (!jobs.initialized) return;
+    pthread_mutex_lock(&jobs.mutex);
+    jobs.quit = true;
+    pthread_cond_broadcast(&jobs.wake);
+    pthread_mutex_unlock(&jobs.mutex);
+    for (int i = 0; i < jobs.workerCount; i++) pthread_join(jobs.threads[i], NULL);
+    jobs.workerCount = 0;
+    pthread_cond_destroy(&jobs.wake);
+    pthread_mutex_destroy(&jobs.mutex);
+    jobs.initialized = false;
+}
+
+int GetJobWorkerCount(void) {
+    return jobs.workerCount;
+}
+
+void ParallelFor(int count, int grain, JobRangeFunc func, void *data) {
+    if (count <= 0) return;
+    if (grain < 1) grain = 1;
+    if (count <= grain || jobs.workerCount == 0 || !pthread_equal(pthread_self(), jobs.owner)) {
+        func(data, 0, count);
+        return;
+    }
+
+    jobs.func = func;
+    jobs.data = data;
+    jobs.grain = grain;
+    atomic_store_explicit(&jobs.remaining, count, memory_order_release);
+    PushRange(&jobs.deques[0], 0, count);
+
+    pthread_mutex_lock(&jobs.mutex);
+    jobs.generation++;
+    pthread_cond_broadcast(&jobs.wake);
+    pthread_mutex_unlock(&jobs.mutex);
+
+    RunUntilDone(0);
+}
+
+#endif // JOBS_SINGLE_THREADED
@@ -0,0 +1,27 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <stdbool.h>
+
+// Small work-stealing scheduler for data-parallel loops. Each thread owns a deque of index
+// ranges: it splits its range in half, pushes one half for others to steal and keeps
+// working on the other. Only the thread that called InitJobs may submit work; calls from
+// any other thread, before InitJobs, or in single-threaded builds run inline.
+
+// wasm builds without pthreads always run single-threaded
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+    #define JOBS_SINGLE_THREADED
+#endif
+
+typedef void (*JobRangeFunc)(void *data, int begin, int end);    // Process items [begin, end)
+
+void InitJobs(int workerCount);     // Spawn helper threads, 0 keeps everything on the caller
+void CloseJobs(void);
+int GetJobWorkerCount(void);        // Helper threads running, 0 when single-threaded
+int GetCpuCount(void);              // Online logical cores
+
+// Run func over [0, count) split into ranges of at least grain items, returns when all are
+// done. Small counts (<= grain) run inline without touching the scheduler.
+void ParallelFor(int count, int grain, JobRangeFunc func, void *data);
+
+#endif // JOBS_H
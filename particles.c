@@ -0,0 +1,193 @@
+#include "particles.h"
+#include "jobs.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX__)
+    #include <immintrin.h>
+    #define PARTICLE_KERNEL "avx"
+#elif defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define PARTICLE_KERNEL "sse2"
+#elif defined(__wasm_simd128__)
+    #include <wasm_simd128.h>
+    #define PARTICLE_KERNEL "simd128"
+#else
+    #define PARTICLE_KERNEL "scalar"
+#endif
+
+#define PARTICLE_LANES 8            // Arrays are padded to this so kernels need no tail loop
+#define PARTICLE_ALIGN 32           // Widest vector load (AVX)
+#define PARTICLE_MIN_CAPACITY 256
+#define PARTICLE_JOB_GRAIN 2048         // Lane blocks per job, 16k particles
+
+static size_t PaddedCount(int capacity) {
+    return ((size_t)capacity + PARTICLE_LANES - 1) & ~(size_t)(PARTICLE_LANES - 1);
+}
+
+static bool AllocateParticles(ParticleSystem *ps, int capacity) {
+    size_t n = PaddedCount(capacity);
+    size_t bytes = n * (6 * sizeof(float) + sizeof(Color)) + PARTICLE_ALIGN;
+    unsigned char *block = calloc(1, bytes);
+    if (!block) return false;
+
+    // All seven arrays live in one block, each aligned and padded to PARTICLE_LANES
+    unsigned char *base = block;
+    base += (PARTICLE_ALIGN - ((size_t)base & (PARTICLE_ALIGN - 1))) & (PARTICLE_ALIGN - 1);
+    float *x = (float *)base;
+    float *y = x + n;
+    float *vx = y + n;
+    float *vy = vx + n;
+    float *alpha = vy + n;
+    float *life = alpha + n;
+    Color *color = (Color *)(life + n);
+
+    if (ps->count > 0) {
+        size_t live = (size_t)ps->count;
+        memcpy(x, ps->x, live * sizeof(float));
+        memcpy(y, ps->y, live * sizeof(float));
+        memcpy(vx, ps->vx, live * sizeof(float));
+        memcpy(vy, ps->vy, live * sizeof(float));
+        memcpy(alpha, ps->alpha, live * sizeof(float));
+        memcpy(life, ps->life, live * sizeof(float));
+        memcpy(color, ps->color, live * sizeof(Color));
+    }
+    free(ps->block);
+
+    ps->block = block;
+    ps->x = x;
+    ps->y = y;
+    ps->vx = vx;
+    ps->vy = vy;
+    ps->alpha = alpha;
+    ps->life = life;
+    ps->color = color;
+    ps->capacity = (int)n;
+    return true;
+}
+
+void InitParticles(ParticleSystem *ps, int maxCapacity) {
+    memset(ps, 0, sizeof(*ps));
+    ps->maxCapacity = maxCapacity;
+}
+
+void UnloadParticles(ParticleSystem *ps) {
+    free(ps->block);
+    memset(ps, 0, sizeof(*ps));
+}
+
+void ClearParticles(ParticleSystem *ps) {
+    ps->count = 0;
+}
+
+bool ReserveParticles(ParticleSystem *ps, int count) {
+    if (count <= ps->capacity) return true;
+    if (count > ps->maxCapacity) return false;
+    int capacity = ps->capacity ? ps->capacity : PARTICLE_MIN_CAPACITY;
+    while (capacity < count) capacity *= 2;
+    if (capacity > ps->maxCapacity) capacity = ps->maxCapacity;
+    return AllocateParticles(ps, capacity);
+}
+
+bool SpawnParticle(ParticleSystem *ps, Vector2 position, Vector2 velocity, Color color) {
+    if (ps->count >= ps->capacity && !ReserveParticles(ps, ps->count + 1)) return false;
+
+    int i = ps->count++;
+    ps->x[i] = position.x;
+    ps->y[i] = position.y;
+    ps->vx[i] = velocity.x;
+    ps->vy[i] = velocity.y;
+    ps->alpha[i] = 1.0f;
+    ps->life[i] = 1.0f;
+    ps->color[i] = color;
+    return true;
+}
+
+typedef struct {
+    ParticleSystem *ps;
+    float step;
+    float decay;
+} IntegrateJob;
+
+// Integrate lane blocks [beginBlock, endBlock): position += velocity * step, alpha and life fade.
+// Slots past count (up to the padded count) hold stale data and are updated harmlessly.
+static void IntegrateParticles(void *data, int beginBlock, int endBlock) {
+    IntegrateJob *job = (IntegrateJob *)data;
+    ParticleSystem *ps = job->ps;
+    float step = job->step;
+    float decay = job->decay;
+    int first = beginBlock * PARTICLE_LANES;
+    int n = (endBlock - beginBlock) * PARTICLE_LANES;
+    float *x = ps->x + first, *y = ps->y + first, *vx = ps->vx + first, *vy = ps->vy + first;
+    float *alpha = ps->alpha + first, *life = ps->life + first;
+
+#if defined(__AVX__)
+    __m256 s = _mm256_set1_ps(step);
+    __m256 d = _mm256_set1_ps(decay);
+    __m256 zero = _mm256_setzero_ps();
+    for (int i = 0; i < n; i += 8) {
+        _mm256_store_ps(x + i, _mm256_add_ps(_mm256_load_ps(x + i), _mm256_mul_ps(_mm256_load_ps(vx + i), s)));
+        _mm256_store_ps(y + i, _mm256_add_ps(_mm256_load_ps(y + i), _mm256_mul_ps(_mm256_load_ps(vy + i), s)));
+        _mm256_store_ps(alpha + i, _mm256_max_ps(_mm256_sub_ps(_mm256_load_ps(alpha + i), d), zero));
+        _mm256_store_ps(life + i, _mm256_sub_ps(_mm256_load_ps(life + i), d));
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    __m128 s = _mm_set1_ps(step);
+    __m128 d = _mm_set1_ps(decay);
+    __m128 zero = _mm_setzero_ps();
+    for (int i = 0; i < n; i += 4) {
+        _mm_store_ps(x + i, _mm_add_ps(_mm_load_ps(x + i), _mm_mul_ps(_mm_load_ps(vx + i), s)));
+        _mm_store_ps(y + i, _mm_add_ps(_mm_load_ps(y + i), _mm_mul_ps(_mm_load_ps(vy + i), s)));
+        _mm_store_ps(alpha + i, _mm_max_ps(_mm_sub_ps(_mm_load_ps(alpha + i), d), zero));
+        _mm_store_ps(life + i, _mm_sub_ps(_mm_load_ps(life + i), d));
+    }
+#elif defined(__wasm_simd128__)
+    v128_t s = wasm_f32x4_splat(step);
+    v128_t d = wasm_f32x4_splat(decay);
+    v128_t zero = wasm_f32x4_splat(0.0f);
+    for (int i = 0; i < n; i += 4) {
+        wasm_v128_store(x + i, wasm_f32x4_add(wasm_v128_load(x + i), wasm_f32x4_mul(wasm_v128_load(vx + i), s)));
+        wasm_v128_store(y + i, wasm_f32x4_add(wasm_v128_load(y + i), wasm_f32x4_mul(wasm_v128_load(vy + i), s)));
+        wasm_v128_store(alpha + i, wasm_f32x4_pmax(wasm_f32x4_sub(wasm_v128_load(alpha + i), d), zero));
+        wasm_v128_store(life + i, wasm_f32x4_sub(wasm_v128_load(life + i), d));
+    }
+#else
+    for (int i = 0; i < n; i++) {
+        x[i] += vx[i] * step;
+        y[i] += vy[i] * step;
+        alpha[i] -= decay;
+        if (alpha[i] < 0) alpha[i] = 0;
+        life[i] -= decay;
+    }
+#endif
+}
+
+// Swap-remove dead particles so [0, count) stays packed; order is not preserved
+static void CompactParticles(ParticleSystem *ps) {
+    int i = 0;
+    while (i < ps->count) {
+        if (ps->life[i] > 0) {
+            i++;
+            continue;
+        }
+        int last = --ps->count;
+        ps->x[i] = ps->x[last];
+        ps->y[i] = ps->y[last];
+        ps->vx[i] = ps->vx[last];
+        ps->vy[i] = ps->vy[last];
+        ps->alpha[i] = ps->alpha[last];
+        ps->life[i] = ps->life[last];
+        ps->color[i] = ps->color[last];
+    }
+}
+
+void UpdateParticles(ParticleSystem *ps, float step, float decay) {
+    if (ps->count == 0) return;
+    IntegrateJob job = {ps, step, decay};
+    ParallelFor((int)(PaddedCount(ps->count) / PARTICLE_LANES), PARTICLE_JOB_GRAIN, IntegrateParticles, &job);
+    CompactParticles(ps);
+}
+
+const char *ParticleKernelName(void) {
+    return PARTICLE_KERNEL;
+}
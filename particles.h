@@ -0,0 +1,30 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include "raylib.h"
+
+// Structure-of-arrays particle store. Live particles are always packed in [0, count),
+// so update and draw loops never test for dead slots.
+typedef struct {
+    float *x;           // Position
+    float *y;
+    float *vx;          // Velocity per step
+    float *vy;
+    float *alpha;       // Transparency (0.0 to 1.0)
+    float *life;        // Remaining lifetime
+    Color *color;       // Color of the particle
+    int count;          // Number of live particles
+    int capacity;       // Allocated slots, grows on demand up to maxCapacity
+    int maxCapacity;    // Hard limit, spawns past it are dropped
+    void *block;        // Single allocation backing all arrays
+} ParticleSystem;
+
+void InitParticles(ParticleSystem *ps, int maxCapacity);
+void UnloadParticles(ParticleSystem *ps);
+void ClearParticles(ParticleSystem *ps);
+bool ReserveParticles(ParticleSystem *ps, int count);     // Grow storage for count live particles, false past maxCapacity
+bool SpawnParticle(ParticleSystem *ps, Vector2 position, Vector2 velocity, Color color);  // False when full
+void UpdateParticles(ParticleSystem *ps, float step, float decay);     // Move by velocity * step, fade by decay, remove dead ones
+const char *ParticleKernelName(void);                      // SIMD path compiled in, for stats output
+
+#endif // PARTICLES_H
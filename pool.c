@@ -0,0 +1,113 @@
+#include "pool.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define POOL_MIN_CAPACITY 16
+
+// Slots only get created while every existing one is live, so slotCount <= count and the
+// slot arrays never need more room than the entry array
+static bool GrowEntityPool(EntityPool *pool, int capacity) {
+    int *slot = realloc(pool->slot, sizeof(int) * capacity);
+    if (slot) pool->slot = slot;
+    int *entry = realloc(pool->entry, sizeof(int) * capacity);
+    if (entry) pool->entry = entry;
+    unsigned int *generation = realloc(pool->generation, sizeof(unsigned int) * capacity);
+    if (generation) pool->generation = generation;
+    if (!slot || !entry || !generation) return false;
+    pool->capacity = capacity;
+    return true;
+}
+
+void InitEntityPool(EntityPool *pool, int capacity, int maxCapacity) {
+    memset(pool, 0, sizeof(*pool));
+    pool->maxCapacity = maxCapacity;
+    pool->freeHead = -1;
+    if (capacity > maxCapacity) capacity = maxCapacity;
+    if (capacity > 0) GrowEntityPool(pool, capacity);
+}
+
+void UnloadEntityPool(EntityPool *pool) {
+    free(pool->slot);
+    free(pool->entry);
+    free(pool->generation);
+    memset(pool, 0, sizeof(*pool));
+    pool->freeHead = -1;
+}
+
+void ClearEntityPool(EntityPool *pool) {
+    while (pool->count > 0) ReleaseEntity(pool, pool->count - 1);
+}
+
+bool ReserveEntityPool(EntityPool *pool, int count) {
+    if (count <= pool->capacity) return true;
+    if (count > pool->maxCapacity) return false;
+    int capacity = pool->capacity ? pool->capacity : POOL_MIN_CAPACITY;
+    while (capacity < count) capacity *= 2;
+    if (capacity > pool->maxCapacity) capacity = pool->maxCapacity;
+    return GrowEntityPool(pool, capacity);
+}
+
+int AcquireEntity(EntityPool *pool) {
+    if (pool->count == pool->capacity) return -1;
+    int slot = pool->freeHead;
+    if (slot >= 0) {
+        pool->freeHead = pool->entry[slot];
+    } else {
+        slot = pool->slotCount++;
+        pool->generation[slot] = 0;
+    }
+    int index = pool->count++;
+    pool->generation[slot]++;
+    pool->entry[slot] = index;
+    pool->slot[index] = slot;
+    return index;
+}
+
+int ReleaseEntity(EntityPool *pool, int index) {
+    int slot = pool->slot[index];
+    int last = --pool->count;
+    pool->slot[index] = pool->slot[last];
+    pool->entry[pool->slot[index]] = index;
+    pool->generation[slot]++;
+    pool->entry[slot] = pool->freeHead;
+    pool->freeHead = slot;
+    return last;
+}
+
+EntityHandle GetEntityHandle(const EntityPool *pool, int index) {
+    int slot = pool->slot[index];
+    return (EntityHandle){slot, pool->generation[slot]};
+}
+
+int ResolveEntity(const EntityPool *pool, EntityHandle handle) {
+    if (handle.slot < 0 || handle.slot >= pool->slotCount || pool->generation[handle.slot] != handle.generation ||
+        !(handle.generation & 1)) return -1;
+    return pool->entry[handle.slot];
+}
+
+void SaveEntityPool(const EntityPool *pool, int *entry, unsigned int *generation) {
+    if (pool->slotCount == 0) return;
+    memcpy(entry, pool->entry, sizeof(int) * pool->slotCount);
+    memcpy(generation, pool->generation, sizeof(unsigned int) * pool->slotCount);
+}
+
+bool LoadEntityPool(EntityPool *pool, int count, int slotCount, int freeHead, const int *entry, const unsigned int *generation) {
+    if (count < 0 || slotCount < count || freeHead < -1 || freeHead >= slotCount ||
+        !ReserveEntityPool(pool, slotCount)) return false;
+    int live = 0;
+    for (int slot = 0; slot < slotCount; slot++) {
+        if (!(generation[slot] & 1)) continue;
+        if (entry[slot] < 0 || entry[slot] >= count) return false;
+        pool->slot[entry[slot]] = slot;
+        live++;
+    }
+    if (live != count) return false;
+    if (slotCount > 0) {
+        memcpy(pool->entry, entry, sizeof(int) * slotCount);
+        memcpy(pool->generation, generation, sizeof(unsigned int) * slotCount);
+    }
+    pool->count = count;
+    pool->slotCount = slotCount;
+    pool->freeHead = freeHead;
+    return true;
+}
@@ -0,0 +1,44 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdbool.h>
+
+// Entity pool: bookkeeping for one entity type whose data the owner keeps in its own
+// array. Live entities are packed in [0, count) of that array, so update loops touch only
+// live ones. Spawning takes the entry at count and despawning moves the last entry into
+// the hole, both O(1). Every entity also gets a slot that stays put while entries move,
+// and a handle (slot plus generation) names it from outside; once the entity despawns
+// the slot's generation moves on and old handles stop resolving.
+// Freed slots are chained in a free list. Storage starts preallocated and doubles when
+// full, up to maxCapacity, so steady state play never allocates.
+typedef struct {
+    int slot;
+    unsigned int generation;
+} EntityHandle;
+
+typedef struct {
+    int count;                  // Live entries
+    int capacity;               // Entries the owner's array and these arrays hold
+    int maxCapacity;            // Hard limit, acquires past it fail
+    int slotCount;              // Slots handed out so far, the free ones are chained from freeHead
+    int freeHead;               // -1 when every slot below slotCount is live
+    int *slot;                  // Per entry: its slot
+    int *entry;                 // Per slot: its entry while live, the next free slot while free
+    unsigned int *generation;   // Per slot: odd while live, bumped on acquire and release
+} EntityPool;
+
+void InitEntityPool(EntityPool *pool, int capacity, int maxCapacity);     // capacity is preallocated
+void UnloadEntityPool(EntityPool *pool);
+void ClearEntityPool(EntityPool *pool);             // Release everything, outstanding handles go stale
+bool ReserveEntityPool(EntityPool *pool, int count);    // Room for count entries, false past maxCapacity
+int AcquireEntity(EntityPool *pool);                // Entry count for the new entity, -1 when full; grow the owner's array to capacity first
+int ReleaseEntity(EntityPool *pool, int index);     // Entry that was moved into index (the old last one), the owner moves its data the same way
+EntityHandle GetEntityHandle(const EntityPool *pool, int index);
+int ResolveEntity(const EntityPool *pool, EntityHandle handle);     // Entry index, -1 once the entity is gone
+
+// Slot state for snapshots: entry and generation hold slotCount values each. Entries of
+// live slots are rebuilt into the per entry slot table on load.
+void SaveEntityPool(const EntityPool *pool, int *entry, unsigned int *generation);
+bool LoadEntityPool(EntityPool *pool, int count, int slotCount, int freeHead, const int *entry, const unsigned int *generation);
+
+#endif // POOL_H
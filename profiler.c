@@ -0,0 +1,181 @@
+#include "profiler.h"
+
+#if defined(PROFILER_ENABLED)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+static const char *phaseNames[PROFILE_PHASE_COUNT] = {
+    "layout", "input", "simulation", "collision", "particles", "hud", "draw", "present"
+};
+
+static const char *counterNames[PROFILE_COUNTER_COUNT] = {
+    "lasers", "enemies", "particles", "collision_tests", "steps", "draw_calls", "sprites", "input_latency_us"
+};
+
+// One frame's measurements, times in seconds
+typedef struct {
+    double frame;                               // Since the previous BeginProfileFrame
+    double phases[PROFILE_PHASE_COUNT];
+    int counters[PROFILE_COUNTER_COUNT];
+} ProfileFrame;
+
+static struct {
+    ProfileFrame frames[PROFILE_FRAMES];
+    int head;                                   // Slot of the frame being recorded
+    int filled;                                 // Completed frames in the ring
+    long long frameNumber;                      // Frames completed since start
+    ProfileFrame current;
+    double frameStart;
+    double phaseStart[PROFILE_PHASE_COUNT];
+    SimulationTotals simulation;                // Totals of the last state profiled
+} profiler;
+
+void BeginProfileFrame(void) {
+    memset(&profiler.current, 0, sizeof(profiler.current));
+    profiler.frameStart = GetTime();
+}
+
+void EndProfileFrame(void) {
+    profiler.current.frame = GetTime() - profiler.frameStart;
+    profiler.frames[profiler.head] = profiler.current;
+    profiler.head = (profiler.head + 1) % PROFILE_FRAMES;
+    if (profiler.filled < PROFILE_FRAMES) profiler.filled++;
+    profiler.frameNumber++;
+}
+
+void BeginProfilePhase(ProfilePhase phase) {
+    profiler.phaseStart[phase] = GetTime();
+}
+
+// Phases may be entered several times per frame, times add up
+void EndProfilePhase(ProfilePhase phase) {
+    profiler.current.phases[phase] += GetTime() - profiler.phaseStart[phase];
+}
+
+void SetProfileCounter(ProfileCounter counter, int value) {
+    profiler.current.counters[counter] = value;
+}
+
+void ProfileSimulation(const RenderState *state) {
+    // Totals only grow, the difference covers states the frontend skipped as well
+    const SimulationTotals *totals = &state->totals;
+    const SimulationTotals *seen = &profiler.simulation;
+    double collision = totals->collisionTime - seen->collisionTime;
+    double particles = totals->particleTime - seen->particleTime;
+    profiler.current.phases[PROFILE_SIMULATION] += totals->stepTime - seen->stepTime - collision - particles;
+    profiler.current.phases[PROFILE_COLLISION] += collision;
+    profiler.current.phases[PROFILE_PARTICLES] += particles;
+
+    int *counters = profiler.current.counters;
+    counters[PROFILE_LASERS] = state->laserCount;
+    counters[PROFILE_ENEMIES] = state->enemiesActive;
+    counters[PROFILE_PARTICLE_COUNT] = state->particleCount;
+    counters[PROFILE_COLLISION_TESTS] += (int)(totals->collisionTests - seen->collisionTests);
+    counters[PROFILE_STEPS] += (int)(totals->steps - seen->steps);
+    profiler.simulation = *totals;
+}
+
+static int CompareFloat(const void *a, const void *b) {
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+// Oldest first
+static const ProfileFrame *GetProfileFrame(int i) {
+    return &profiler.frames[(profiler.head - profiler.filled + i + PROFILE_FRAMES) % PROFILE_FRAMES];
+}
+
+// p50 and p99 in milliseconds of one phase over the ring, phase == PROFILE_PHASE_COUNT is the frame
+static void PhasePercentiles(int phase, float *p50, float *p99) {
+    float samples[PROFILE_FRAMES];
+    for (int i = 0; i < profiler.filled; i++) {
+        const ProfileFrame *frame = GetProfileFrame(i);
+        samples[i] = (float)(1000.0 * ((phase == PROFILE_PHASE_COUNT) ? frame->frame : frame->phases[phase]));
+    }
+    qsort(samples, profiler.filled, sizeof(float), CompareFloat);
+    *p50 = samples[(profiler.filled - 1) / 2];
+    *p99 = samples[(profiler.filled - 1) * 99 / 100];
+}
+
+void DrawProfiler(int x, int y) {
+    if (profiler.filled == 0) return;
+
+    const int width = PROFILE_FRAMES * 2;
+    const int graphHeight = 100;
+    const float graphMs = 50.0f;                // Top of the graph
+    const int lineHeight = 12;
+    int height = graphHeight + (PROFILE_PHASE_COUNT + 2) * lineHeight + 4 * lineHeight + 16;
+    DrawRectangle(x, y, width + 12, height, Fade(BLACK, 0.8f));
+    x += 6;
+    y += 6;
+
+    // Frame time graph, newest on the right, with 60 and 30 fps lines
+    for (int i = 0; i < profiler.filled; i++) {
+        float ms = (float)(1000.0 * GetProfileFrame(i)->frame);
+        int barHeight = (int)(fminf(ms / graphMs, 1.0f) * graphHeight);
+        Color color = (ms > 33.4f) ? RED : (ms > 16.7f) ? ORANGE : LIME;
+        DrawRectangle(x + width - (profiler.filled - i) * 2, y + graphHeight - barHeight, 2, barHeight, color);
+    }
+    DrawLine(x, y + graphHeight - (int)(16.7f / graphMs * graphHeight), x + width, y + graphHeight - (int)(16.7f / graphMs * graphHeight), Fade(WHITE, 0.5f));
+    DrawLine(x, y + graphHeight - (int)(33.3f / graphMs * graphHeight), x + width, y + graphHeight - (int)(33.3f / graphMs * graphHeight), Fade(WHITE, 0.5f));
+    y += graphHeight + 6;
+
+    DrawText(TextFormat("%-12s %8s %8s", "phase", "p50 ms", "p99 ms"), x, y, 10, GRAY);
+    y += lineHeight;
+    for (int phase = 0; phase <= PROFILE_PHASE_COUNT; phase++) {
+        float p50, p99;
+        PhasePercentiles(phase, &p50, &p99);
+        const char *name = (phase == PROFILE_PHASE_COUNT) ? "frame" : phaseNames[phase];
+        DrawText(TextFormat("%-12s %8.3f %8.3f", name, p50, p99), x, y, 10, (phase == PROFILE_PHASE_COUNT) ? YELLOW : RAYWHITE);
+        y += lineHeight;
+    }
+
+    // Counters of the newest frame
+    const int *counters = GetProfileFrame(profiler.filled - 1)->counters;
+    DrawText(TextFormat("lasers %d  enemies %d  particles %d", counters[PROFILE_LASERS], counters[PROFILE_ENEMIES],
+                        counters[PROFILE_PARTICLE_COUNT]), x, y, 10, RAYWHITE);
+    y += lineHeight;
+    DrawText(TextFormat("steps %d  collision tests %d", counters[PROFILE_STEPS], counters[PROFILE_COLLISION_TESTS]), x, y, 10, RAYWHITE);
+    y += lineHeight;
+    DrawText(TextFormat("draw calls %d  sprites %d", counters[PROFILE_DRAW_CALLS], counters[PROFILE_SPRITES]), x, y, 10, RAYWHITE);
+    y += lineHeight;
+
+    // Input latency over the frames that showed a press
+    float latency[PROFILE_FRAMES];
+    int presses = 0;
+    for (int i = 0; i < profiler.filled; i++) {
+        int us = GetProfileFrame(i)->counters[PROFILE_INPUT_LATENCY];
+        if (us > 0) latency[presses++] = us / 1000.0f;
+    }
+    if (presses > 0) {
+        qsort(latency, presses, sizeof(float), CompareFloat);
+        DrawText(TextFormat("input latency p50 %.1f ms  p99 %.1f ms", latency[(presses - 1) / 2], latency[(presses - 1) * 99 / 100]), x, y, 10, RAYWHITE);
+    } else {
+        DrawText("input latency: no presses", x, y, 10, GRAY);
+    }
+}
+
+bool ExportProfile(const char *fileName) {
+    FILE *file = fopen(fileName, "w");
+    if (!file) return false;
+
+    fprintf(file, "frame,frame_ms");
+    for (int p = 0; p < PROFILE_PHASE_COUNT; p++) fprintf(file, ",%s_ms", phaseNames[p]);
+    for (int c = 0; c < PROFILE_COUNTER_COUNT; c++) fprintf(file, ",%s", counterNames[c]);
+    fprintf(file, "\n");
+
+    for (int i = 0; i < profiler.filled; i++) {
+        const ProfileFrame *frame = GetProfileFrame(i);
+        fprintf(file, "%lld,%.4f", profiler.frameNumber - profiler.filled + i, 1000.0 * frame->frame);
+        for (int p = 0; p < PROFILE_PHASE_COUNT; p++) fprintf(file, ",%.4f", 1000.0 * frame->phases[p]);
+        for (int c = 0; c < PROFILE_COUNTER_COUNT; c++) fprintf(file, ",%d", frame->counters[c]);
+        fprintf(file, "\n");
+    }
+
+    return fclose(file) == 0;
+}
+
+#endif // PROFILER_ENABLED
@@ -0,0 +1,72 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "raylib.h"
+#include "simulation.h"
+
+// Frame profiler: phase timers and counters for the last PROFILE_FRAMES frames, an overlay
+// with a frame time graph and p50/p99 per phase, and CSV export.
+// Only compiled in development builds: defining NDEBUG (release) or PROFILER_DISABLED turns
+// every PROFILE_* macro into nothing, and profiler.c into an empty unit.
+#if !defined(NDEBUG) && !defined(PROFILER_DISABLED)
+    #define PROFILER_ENABLED
+#endif
+
+#define PROFILE_FRAMES 240      // Ring buffer length, 4 seconds at 60 fps
+
+typedef enum {
+    PROFILE_LAYOUT = 0,     // Window size, viewport, HUD and touch control layout
+    PROFILE_INPUT,          // Input polling (key queue, touch map, joystick) and handing it to the simulation
+    PROFILE_SIMULATION,     // World steps since the last frame's state, minus the two phases below; thread time when threaded
+    PROFILE_COLLISION,      // Laser and player hit tests inside the steps
+    PROFILE_PARTICLES,      // Particle update inside the steps
+    PROFILE_HUD,            // HUD texture updates
+    PROFILE_DRAW,           // Building and flushing sprite layers, HUD composite
+    PROFILE_PRESENT,        // EndDrawing: swap and vsync wait
+    PROFILE_PHASE_COUNT
+} ProfilePhase;
+
+typedef enum {
+    PROFILE_LASERS = 0,     // Lasers in flight in the frame's state
+    PROFILE_ENEMIES,
+    PROFILE_PARTICLE_COUNT,
+    PROFILE_COLLISION_TESTS,    // Enemy distance checks over all steps this frame
+    PROFILE_STEPS,              // Simulation steps since the last frame's state
+    PROFILE_DRAW_CALLS,         // Sprite batch draw calls
+    PROFILE_SPRITES,
+    PROFILE_INPUT_LATENCY,      // Microseconds from polling the oldest press shown this frame to present, 0 when none
+    PROFILE_COUNTER_COUNT
+} ProfileCounter;
+
+#if defined(PROFILER_ENABLED)
+
+void BeginProfileFrame(void);
+void EndProfileFrame(void);
+void BeginProfilePhase(ProfilePhase phase);
+void EndProfilePhase(ProfilePhase phase);
+void SetProfileCounter(ProfileCounter counter, int value);
+void ProfileSimulation(const RenderState *state);       // Once per frame: charge the steps behind the state to it
+void DrawProfiler(int x, int y);
+bool ExportProfile(const char *fileName);               // Ring buffer as CSV, oldest frame first
+
+#define PROFILE_FRAME_BEGIN() BeginProfileFrame()
+#define PROFILE_FRAME_END() EndProfileFrame()
+#define PROFILE_BEGIN(phase) BeginProfilePhase(phase)
+#define PROFILE_END(phase) EndProfilePhase(phase)
+#define PROFILE_COUNTER(counter, value) SetProfileCounter(counter, value)
+#define PROFILE_SIMULATION_STATE(state) ProfileSimulation(state)
+#define PROFILE_ATTACH_WORLD(world) ((world)->clock = GetTime)    // Let StepWorld time its phases
+
+#else
+
+#define PROFILE_FRAME_BEGIN() ((void)0)
+#define PROFILE_FRAME_END() ((void)0)
+#define PROFILE_BEGIN(phase) ((void)0)
+#define PROFILE_END(phase) ((void)0)
+#define PROFILE_COUNTER(counter, value) ((void)0)
+#define PROFILE_SIMULATION_STATE(state) ((void)0)
+#define PROFILE_ATTACH_WORLD(world) ((void)0)
+
+#endif // PROFILER_ENABLED
+
+#endif // PROFILER_H
@@ -0,0 +1,78 @@
+#include "quality.h"
+#include "world.h"
+
+#define QUALITY_OVER_INTERVAL 1.15f     // Mean interval past this share of the budget lowers the level
+#define QUALITY_OVER_BUSY 0.95f         // So does mean busy time past this share
+#define QUALITY_GOOD_INTERVAL 1.05f     // A window has headroom with the interval on budget...
+#define QUALITY_GOOD_BUSY 0.6f          // ...and busy time under this share of it
+#define QUALITY_BOUNCE_WINDOWS 2        // Lowered again within this many windows of a raise: it bounced
+#define QUALITY_MAX_RESTORE_WINDOWS 32
+
+// Cheapest last. Explosion sparks stay visible at every level, background fireworks and
+// the long tail of old sparks go first.
+static const QualitySettings levels[QUALITY_LEVELS] = {
+    {1, MAX_PARTICLES, 1},
+    {2, 32768, 2},
+    {4, 8192, 4},
+    {0, 2048, 8},
+};
+
+void InitQuality(QualityGovernor *quality, float budget) {
+    *quality = (QualityGovernor){0};
+    quality->budget = budget;
+    quality->restoreWindows = QUALITY_RESTORE_WINDOWS;
+    quality->lastRaiseWindow = -QUALITY_BOUNCE_WINDOWS - 1;
+}
+
+void UpdateQuality(QualityGovernor *quality, float interval, float busy) {
+    quality->intervalSum += interval;
+    quality->busySum += busy;
+    if (++quality->frames < QUALITY_WINDOW) return;
+
+    quality->frameTime = (float)(quality->intervalSum / quality->frames);
+    quality->busyTime = (float)(quality->busySum / quality->frames);
+    quality->frames = 0;
+    quality->intervalSum = 0.0;
+    quality->busySum = 0.0;
+    quality->windows++;
+
+    float budget = quality->budget;
+    bool over = quality->frameTime > budget * QUALITY_OVER_INTERVAL || quality->busyTime > budget * QUALITY_OVER_BUSY;
+    bool good = quality->frameTime <= budget * QUALITY_GOOD_INTERVAL && quality->busyTime < budget * QUALITY_GOOD_BUSY;
+
+    if (over) {
+        quality->goodWindows = 0;
+        if (quality->level == QUALITY_LEVELS - 1) return;
+        quality->level++;
+        quality->lowered++;
+        if (quality->windows - quality->lastRaiseWindow <= QUALITY_BOUNCE_WINDOWS &&
+            quality->restoreWindows < QUALITY_MAX_RESTORE_WINDOWS) {
+            quality->restoreWindows *= 2;
+        }
+    } else if (good && quality->level > 0) {
+        if (++quality->goodWindows < quality->restoreWindows) return;
+        quality->goodWindows = 0;
+        quality->level--;
+        quality->raised++;
+        quality->lastRaiseWindow = quality->windows;
+    } else {
+        quality->goodWindows = 0;
+    }
+}
+
+QualitySettings GetQualitySettings(const QualityGovernor *quality) {
+    return levels[quality->level];
+}
+
+QualityStats GetQualityStats(const QualityGovernor *quality) {
+    QualityStats stats = {
+        .level = quality->level,
+        .budget = quality->budget * 1000.0f,
+        .frameTime = quality->frameTime * 1000.0f,
+        .busyTime = quality->busyTime * 1000.0f,
+        .lowered = quality->lowered,
+        .raised = quality->raised,
+        .settings = levels[quality->level],
+    };
+    return stats;
+}
@@ -0,0 +1,57 @@
+#ifndef QUALITY_H
+#define QUALITY_H
+
+#include <stdbool.h>
+
+// Quality governor: compares recent frames against a frame time budget and trades effects
+// for frame rate in steps. A window of frames over budget lowers the level right away;
+// raising it back needs several windows in a row with plenty of headroom, and every level
+// that had to be dropped again soon after is held back twice as long next time.
+//
+// Two signals per frame: the interval since the previous frame, which catches anything that
+// makes frames late (GPU, compositor, a slow present), and the busy time spent outside the
+// frame cap wait, which shows the headroom the interval hides behind vsync.
+#define QUALITY_LEVELS 4            // 0 is full quality
+#define QUALITY_WINDOW 30           // Frames per decision
+#define QUALITY_RESTORE_WINDOWS 4   // Good windows in a row before raising the level, doubles on a bounce
+
+// What one level costs. Fireworks and the particle budget go to the world (they only change
+// which sparks exist), the HUD interval applies to the frontend.
+typedef struct {
+    int fireworkEvery;          // World.fireworkEvery: 1 shows every background firework, 0 none
+    int particleBudget;         // World.particleBudget
+    int hudInterval;            // Frames between HUD texture updates
+} QualitySettings;
+
+typedef struct {
+    float budget;               // Seconds per frame to stay under
+    int level;
+    int frames;                 // Frames in the current window
+    double intervalSum;
+    double busySum;
+    int goodWindows;            // Windows in a row with headroom
+    int restoreWindows;         // Good windows needed to raise the level
+    int lastRaiseWindow;        // Window count when the level was last raised
+    int windows;                // Windows evaluated so far
+    int lowered;                // Times the level went down
+    int raised;                 // Times it came back up
+    float frameTime;            // Mean interval of the last window
+    float busyTime;             // Mean busy time of the last window
+} QualityGovernor;
+
+typedef struct {
+    int level;
+    float budget;               // Milliseconds
+    float frameTime;            // Mean interval over the last window, milliseconds
+    float busyTime;             // Mean busy time over the last window, milliseconds
+    int lowered;
+    int raised;
+    QualitySettings settings;
+} QualityStats;
+
+void InitQuality(QualityGovernor *quality, float budget);
+void UpdateQuality(QualityGovernor *quality, float interval, float busy);      // Once per frame, skip frames paced on purpose (idle)
+QualitySettings GetQualitySettings(const QualityGovernor *quality);
+QualityStats GetQualityStats(const QualityGovernor *quality);
+
+#endif // QUALITY_H
@@ -0,0 +1,197 @@
+#include "raster.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+bool LoadCanvas(Canvas *canvas, int width, int height) {
+    canvas->pixels = (width > 0 && height > 0) ? calloc((size_t)width * height, sizeof(Color)) : NULL;
+    canvas->width = canvas->pixels ? width : 0;
+    canvas->height = canvas->pixels ? height : 0;
+    return canvas->pixels != NULL;
+}
+
+void UnloadCanvas(Canvas *canvas) {
+    free(canvas->pixels);
+    canvas->pixels = NULL;
+}
+
+void ClearCanvas(Canvas *canvas, Color color) {
+    size_t count = (size_t)canvas->width * canvas->height;
+    for (size_t i = 0; i < count; i++) canvas->pixels[i] = color;
+}
+
+void BlendCanvasPixel(Canvas *canvas, int x, int y, Color color) {
+    if (x < 0 || y < 0 || x >= canvas->width || y >= canvas->height || color.a == 0) return;
+    Color *dst = &canvas->pixels[(size_t)y * canvas->width + x];
+    if (color.a == 255) {
+        *dst = color;
+        return;
+    }
+    int a = color.a, inv = 255 - a;
+    dst->r = (unsigned char)((color.r * a + dst->r * inv + 127) / 255);
+    dst->g = (unsigned char)((color.g * a + dst->g * inv + 127) / 255);
+    dst->b = (unsigned char)((color.b * a + dst->b * inv + 127) / 255);
+    dst->a = (unsigned char)(a + (dst->a * inv + 127) / 255);
+}
+
+static Color ScaleAlpha(Color color, float coverage) {
+    color.a = (unsigned char)(color.a * coverage + 0.5f);
+    return color;
+}
+
+void FillCanvasCircle(Canvas *canvas, Vector2 center, float radius, Color color) {
+    int x0 = (int)floorf(center.x - radius - 1.0f), x1 = (int)ceilf(center.x + radius + 1.0f);
+    int y0 = (int)floorf(center.y - radius - 1.0f), y1 = (int)ceilf(center.y + radius + 1.0f);
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > canvas->width - 1) x1 = canvas->width - 1;
+    if (y1 > canvas->height - 1) y1 = canvas->height - 1;
+    for (int y = y0; y <= y1; y++) {
+        float dy = y + 0.5f - center.y;
+        for (int x = x0; x <= x1; x++) {
+            float dx = x + 0.5f - center.x;
+            float coverage = radius + 0.5f - sqrtf(dx * dx + dy * dy);
+            if (coverage <= 0.0f) continue;
+            BlendCanvasPixel(canvas, x, y, (coverage >= 1.0f) ? color : ScaleAlpha(color, coverage));
+        }
+    }
+}
+
+static float EdgeFunction(Vector2 a, Vector2 b, float x, float y) {
+    return (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x);
+}
+
+// Pixel centers inside all three edges, either winding
+void FillCanvasTriangle(Canvas *canvas, Vector2 v1, Vector2 v2, Vector2 v3, Color color) {
+    float area = EdgeFunction(v1, v2, v3.x, v3.y);
+    if (area == 0.0f) return;
+    float sign = (area > 0.0f) ? 1.0f : -1.0f;
+    int x0 = (int)floorf(fminf(v1.x, fminf(v2.x, v3.x))), x1 = (int)ceilf(fmaxf(v1.x, fmaxf(v2.x, v3.x)));
+    int y0 = (int)floorf(fminf(v1.y, fminf(v2.y, v3.y))), y1 = (int)ceilf(fmaxf(v1.y, fmaxf(v2.y, v3.y)));
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > canvas->width - 1) x1 = canvas->width - 1;
+    if (y1 > canvas->height - 1) y1 = canvas->height - 1;
+    for (int y = y0; y <= y1; y++) {
+        for (int x = x0; x <= x1; x++) {
+            float px = x + 0.5f, py = y + 0.5f;
+            if (sign * EdgeFunction(v1, v2, px, py) >= 0.0f && sign * EdgeFunction(v2, v3, px, py) >= 0.0f &&
+                sign * EdgeFunction(v3, v1, px, py) >= 0.0f) {
+                BlendCanvasPixel(canvas, x, y, color);
+            }
+        }
+    }
+}
+
+void DrawCanvasLine(Canvas *canvas, Vector2 start, Vector2 end, Color color) {
+    float dx = end.x - start.x, dy = end.y - start.y;
+    int steps = (int)ceilf(fmaxf(fabsf(dx), fabsf(dy)));
+    if (steps < 1) steps = 1;
+    for (int i = 0; i <= steps; i++) {
+        float t = (float)i / steps;
+        BlendCanvasPixel(canvas, (int)floorf(start.x + dx * t), (int)floorf(start.y + dy * t), color);
+    }
+}
+
+bool WriteCanvasRGBA(const Canvas *canvas, FILE *file) {
+    size_t count = (size_t)canvas->width * canvas->height;
+    return fwrite(canvas->pixels, sizeof(Color), count, file) == count;
+}
+
+//----------------------------------------------------------------------------------
+// PNG: one IDAT holding a zlib stream of stored deflate blocks, every row with filter 0.
+// Larger than a compressed PNG, but costs no more than a copy to write.
+//----------------------------------------------------------------------------------
+static unsigned int crcTable[256];
+
+static unsigned int UpdateCrc(unsigned int crc, const unsigned char *bytes, size_t count) {
+    if (crcTable[1] == 0) {
+        for (unsigned int n = 0; n < 256; n++) {
+            unsigned int c = n;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            crcTable[n] = c;
+        }
+    }
+    for (size_t i = 0; i < count; i++) crc = crcTable[(crc ^ bytes[i]) & 0xff] ^ (crc >> 8);
+    return crc;
+}
+
+static void PutU32(unsigned char *out, unsigned int value) {
+    out[0] = (unsigned char)(value >> 24);
+    out[1] = (unsigned char)(value >> 16);
+    out[2] = (unsigned char)(value >> 8);
+    out[3] = (unsigned char)value;
+}
+
+// Chunk length, type, data and CRC over type and data
+static bool WriteChunk(FILE *file, const char *type, const unsigned char *data, size_t size) {
+    unsigned char header[8], footer[4];
+    PutU32(header, (unsigned int)size);
+    memcpy(header + 4, type, 4);
+    unsigned int crc = UpdateCrc(0xffffffffu, header + 4, 4);
+    crc = UpdateCrc(crc, data, size) ^ 0xffffffffu;
+    PutU32(footer, crc);
+    return fwrite(header, 1, 8, file) == 8 && (size == 0 || fwrite(data, 1, size, file) == size) && fwrite(footer, 1, 4, file) == 4;
+}
+
+bool ExportCanvasPNG(const Canvas *canvas, const char *fileName) {
+    // PNG has no empty images, and the deflate stream needs at least one block
+    if (canvas->width <= 0 || canvas->height <= 0 || !canvas->pixels) return false;
+    size_t rowBytes = (size_t)canvas->width * 4 + 1;
+    size_t rawSize = rowBytes * canvas->height;
+    size_t blocks = (rawSize + 65534) / 65535;
+    size_t zlibSize = 2 + blocks * 5 + rawSize + 4;
+    unsigned char *raw = malloc(rawSize);
+    unsigned char *zlib = malloc(zlibSize);
+    FILE *file = fopen(fileName, "wb");
+    bool ok = raw && zlib && file;
+
+    if (ok) {
+        for (int y = 0; y < canvas->height; y++) {
+            raw[y * rowBytes] = 0;
+            memcpy(raw + y * rowBytes + 1, canvas->pixels + (size_t)y * canvas->width, rowBytes - 1);
+        }
+
+        unsigned char *out = zlib;
+        *out++ = 0x78;      // Deflate, 32K window, no dictionary, check bits for 0x78 0x01
+        *out++ = 0x01;
+        unsigned int a = 1, b = 0;
+        for (size_t offset = 0; offset < rawSize; offset += 65535) {
+            size_t length = (rawSize - offset < 65535) ? rawSize - offset : 65535;
+            *out++ = (offset + length == rawSize) ? 1 : 0;      // Final block flag, type 00 (stored)
+            *out++ = (unsigned char)length;
+            *out++ = (unsigned char)(length >> 8);
+            *out++ = (unsigned char)~length;
+            *out++ = (unsigned char)(~length >> 8);
+            memcpy(out, raw + offset, length);
+            out += length;
+            // Adler-32, reduced every 5552 bytes: the most that cannot overflow 32 bits
+            for (size_t i = offset; i < offset + length;) {
+                size_t run = offset + length - i;
+                if (run > 5552) run = 5552;
+                for (size_t end = i + run; i < end; i++) {
+                    a += raw[i];
+                    b += a;
+                }
+                a %= 65521;
+                b %= 65521;
+            }
+        }
+        PutU32(out, (b << 16) | a);
+
+        static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+        unsigned char ihdr[13];
+        PutU32(ihdr, (unsigned int)canvas->width);
+        PutU32(ihdr + 4, (unsigned int)canvas->height);
+        ihdr[8] = 8;        // Bit depth
+        ihdr[9] = 6;        // RGBA
+        ihdr[10] = ihdr[11] = ihdr[12] = 0;     // Deflate, adaptive filters, no interlace
+        ok = fwrite(signature, 1, 8, file) == 8 && WriteChunk(file, "IHDR", ihdr, sizeof(ihdr)) &&
+             WriteChunk(file, "IDAT", zlib, zlibSize) && WriteChunk(file, "IEND", NULL, 0);
+    }
+
+    if (file && fclose(file) != 0) ok = false;
+    free(raw);
+    free(zlib);
+    return ok;
+}
@@ -0,0 +1,26 @@
+#ifndef RASTER_H
+#define RASTER_H
+
+#include "raylib.h"
+#include <stdio.h>
+
+// Software rasterizer for offline captures: the sprite shapes the game draws (antialiased
+// circles, triangles, lines, pixels) alpha blended into an RGBA buffer on the CPU, with
+// no window, GL context or raylib library involved. Only raylib's types are used.
+typedef struct {
+    int width;
+    int height;
+    Color *pixels;          // Row major, top row first
+} Canvas;
+
+bool LoadCanvas(Canvas *canvas, int width, int height);      // False, and an empty canvas, when out of memory or not at least 1x1
+void UnloadCanvas(Canvas *canvas);
+void ClearCanvas(Canvas *canvas, Color color);
+void BlendCanvasPixel(Canvas *canvas, int x, int y, Color color);     // Source over, clipped
+void FillCanvasCircle(Canvas *canvas, Vector2 center, float radius, Color color);    // Edge antialiased over one pixel
+void FillCanvasTriangle(Canvas *canvas, Vector2 v1, Vector2 v2, Vector2 v3, Color color);
+void DrawCanvasLine(Canvas *canvas, Vector2 start, Vector2 end, Color color);     // One pixel wide
+bool WriteCanvasRGBA(const Canvas *canvas, FILE *file);           // Raw frame, width * height * 4 bytes
+bool ExportCanvasPNG(const Canvas *canvas, const char *fileName);     // 8-bit RGBA, stored (uncompressed) deflate; false for an empty canvas
+
+#endif // RASTER_H
@@ -0,0 +1,182 @@
+#include "replay.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REPLAY_VERSION 6
+#define REPLAY_HEADER_SIZE 24
+
+enum {
+    TICK_LEFT = 1 << 0,
+    TICK_RIGHT = 1 << 1,
+    TICK_UP = 1 << 2,
+    TICK_DOWN = 1 << 3,
+    TICK_FIRE = 1 << 4,
+    TICK_RESTART = 1 << 5,
+    TICK_JOYSTICK = 1 << 6,
+};
+
+static void PutBytes(InputRecording *rec, const unsigned char *bytes, int count) {
+    if (rec->size + count > rec->capacity) {
+        int capacity = rec->capacity ? rec->capacity : 4096;
+        while (capacity < rec->size + count) capacity *= 2;
+        rec->data = realloc(rec->data, capacity);
+        rec->capacity = capacity;
+    }
+    memcpy(rec->data + rec->size, bytes, count);
+    rec->size += count;
+}
+
+static void WriteU16(unsigned char *out, unsigned int value) {
+    out[0] = (unsigned char)value;
+    out[1] = (unsigned char)(value >> 8);
+}
+
+static void WriteU32(unsigned char *out, unsigned int value) {
+    for (int i = 0; i < 4; i++) out[i] = (unsigned char)(value >> (8 * i));
+}
+
+static unsigned int ReadU16(const unsigned char *in) {
+    return in[0] | (unsigned int)in[1] << 8;
+}
+
+static unsigned int ReadU32(const unsigned char *in) {
+    return in[0] | (unsigned int)in[1] << 8 | (unsigned int)in[2] << 16 | (unsigned int)in[3] << 24;
+}
+
+// Floats travel as their bit pattern so playback gets exactly the recorded value
+static void WriteF32(unsigned char *out, float value) {
+    unsigned int bits;
+    memcpy(&bits, &value, sizeof(bits));
+    WriteU32(out, bits);
+}
+
+static float ReadF32(const unsigned char *in) {
+    unsigned int bits = ReadU32(in);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void BeginRecording(InputRecording *rec, const World *world, unsigned int seed) {
+    memset(rec, 0, sizeof(*rec));
+    rec->seed = seed;
+    rec->width = world->width;
+    rec->height = world->height;
+    rec->enemyLimit = world->enemyLimit;
+    rec->enemyWave = world->enemyWave;
+}
+
+void InitRecordedWorld(World *world, const InputRecording *rec) {
+    InitWorld(world, rec->width, rec->height, rec->seed);
+    world->enemyLimit = rec->enemyLimit;
+    world->enemyWave = rec->enemyWave;
+}
+
+void RecordTick(InputRecording *rec, const GameInputs *inputs) {
+    unsigned char bytes[9];
+    int count = 1;
+    unsigned char flags = 0;
+    if (inputs->left) flags |= TICK_LEFT;
+    if (inputs->right) flags |= TICK_RIGHT;
+    if (inputs->up) flags |= TICK_UP;
+    if (inputs->down) flags |= TICK_DOWN;
+    if (inputs->fire) flags |= TICK_FIRE;
+    if (inputs->restart) flags |= TICK_RESTART;
+    if (inputs->joystick) flags |= TICK_JOYSTICK;
+
+    if (inputs->joystick) {
+        WriteF32(bytes + count, inputs->stick.x);
+        WriteF32(bytes + count + 4, inputs->stick.y);
+        count += 8;
+    }
+    bytes[0] = flags;
+
+    PutBytes(rec, bytes, count);
+    rec->ticks++;
+}
+
+bool SaveRecording(const InputRecording *rec, const char *fileName) {
+    FILE *file = fopen(fileName, "wb");
+    if (!file) return false;
+
+    unsigned char header[REPLAY_HEADER_SIZE];
+    memcpy(header, "FIRP", 4);
+    WriteU16(header + 4, REPLAY_VERSION);
+    WriteU16(header + 6, WORLD_TICK_RATE);
+    WriteU32(header + 8, rec->seed);
+    WriteU16(header + 12, rec->width);
+    WriteU16(header + 14, rec->height);
+    WriteU32(header + 16, rec->ticks);
+    WriteU16(header + 20, rec->enemyLimit);
+    WriteU16(header + 22, rec->enemyWave);
+
+    bool ok = fwrite(header, 1, sizeof(header), file) == sizeof(header) &&
+              (rec->size == 0 || fwrite(rec->data, 1, rec->size, file) == (size_t)rec->size);
+    return (fclose(file) == 0) && ok;
+}
+
+bool LoadRecording(InputRecording *rec, const char *fileName) {
+    memset(rec, 0, sizeof(*rec));
+    FILE *file = fopen(fileName, "rb");
+    if (!file) return false;
+
+    unsigned char header[REPLAY_HEADER_SIZE];
+    if (fread(header, 1, sizeof(header), file) != sizeof(header) || memcmp(header, "FIRP", 4) != 0 ||
+        ReadU16(header + 4) != REPLAY_VERSION || ReadU16(header + 6) != WORLD_TICK_RATE) {
+        fclose(file);
+        return false;
+    }
+    rec->seed = ReadU32(header + 8);
+    rec->width = (int)ReadU16(header + 12);
+    rec->height = (int)ReadU16(header + 14);
+    rec->ticks = (int)ReadU32(header + 16);
+    rec->enemyLimit = (int)ReadU16(header + 20);
+    rec->enemyWave = (int)ReadU16(header + 22);
+
+    // Rest of the file is the tick stream
+    unsigned char chunk[4096];
+    size_t read;
+    while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0) PutBytes(rec, chunk, (int)read);
+    fclose(file);
+
+    RewindRecording(rec);
+    return true;
+}
+
+void UnloadRecording(InputRecording *rec) {
+    free(rec->data);
+    memset(rec, 0, sizeof(*rec));
+}
+
+void RewindRecording(InputRecording *rec) {
+    rec->cursor = 0;
+    rec->tick = 0;
+}
+
+bool ReadRecordedTick(InputRecording *rec, GameInputs *inputs) {
+    if (rec->tick >= rec->ticks || rec->cursor >= rec->size) return false;
+
+    unsigned char flags = rec->data[rec->cursor];
+    int needed = (flags & TICK_JOYSTICK) ? 9 : 1;
+    if (rec->cursor + needed > rec->size) return false;     // Truncated file
+    const unsigned char *in = rec->data + rec->cursor + 1;
+
+    memset(inputs, 0, sizeof(*inputs));
+    inputs->left = (flags & TICK_LEFT) != 0;
+    inputs->right = (flags & TICK_RIGHT) != 0;
+    inputs->up = (flags & TICK_UP) != 0;
+    inputs->down = (flags & TICK_DOWN) != 0;
+    inputs->fire = (flags & TICK_FIRE) != 0;
+    inputs->restart = (flags & TICK_RESTART) != 0;
+    inputs->joystick = (flags & TICK_JOYSTICK) != 0;
+
+    if (flags & TICK_JOYSTICK) {
+        inputs->stick.x = ReadF32(in);
+        inputs->stick.y = ReadF32(in + 4);
+    }
+
+    rec->cursor += needed;
+    rec->tick++;
+    return true;
+}
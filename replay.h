@@ -0,0 +1,42 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "world.h"
+
+// Per-tick input log for reproducing a session exactly. A world started with the recorded
+// seed and size and stepped with the recorded inputs ends up bit-identical to the original.
+// The playfield size and enemy limits are fixed for a session and stored once in the header.
+//
+// File layout, little endian:
+//   header  "FIRP", u16 version, u16 tick rate, u32 seed, u16 width, u16 height, u32 ticks,
+//           u16 enemy limit, u16 enemy wave
+//   ticks   u8 flags (left, right, up, down, fire, restart, joystick; bit 0 first, bit 7 unused)
+//           [f32 stick x, f32 stick y] when the joystick is held
+// Touch is stored as the joystick and fire inputs it produced, an idle tick is one byte.
+typedef struct {
+    unsigned int seed;
+    int width;              // Playfield size
+    int height;
+    int enemyLimit;         // World.enemyLimit and enemyWave of the session
+    int enemyWave;
+    int ticks;              // Ticks recorded
+    unsigned char *data;    // Encoded ticks
+    int size;
+    int capacity;
+
+    // Decoder position while playing back
+    int cursor;
+    int tick;
+} InputRecording;
+
+void BeginRecording(InputRecording *rec, const World *world, unsigned int seed);     // world as passed to the first step
+void InitRecordedWorld(World *world, const InputRecording *rec);    // Fresh world matching the recorded session
+void RecordTick(InputRecording *rec, const GameInputs *inputs);
+bool SaveRecording(const InputRecording *rec, const char *fileName);
+bool LoadRecording(InputRecording *rec, const char *fileName);    // False on missing or foreign file
+void UnloadRecording(InputRecording *rec);
+
+void RewindRecording(InputRecording *rec);
+bool ReadRecordedTick(InputRecording *rec, GameInputs *inputs);   // False past the end
+
+#endif // REPLAY_H
@@ -0,0 +1,307 @@
+#define _POSIX_C_SOURCE 200809L  // nanosleep
+#include "simulation.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SIMULATION_STATE_FRESH 4        // Set in middle while it holds a state the reader has not taken
+#define SIMULATION_MAX_BACKLOG 0.15     // Seconds of steps caught up after a stall, longer ones are dropped
+#define REWIND_TICKS_PER_FRAME 2        // Ticks per rewind frame restored, scrubs back at twice the capture rate
+
+//----------------------------------------------------------------------------------
+// Single producer, single consumer ring: each index has one writer, so a release store of
+// it publishes the item written before it
+//----------------------------------------------------------------------------------
+static void InitSpscQueue(SpscQueue *queue, int itemSize) {
+    queue->items = malloc((size_t)itemSize * SIMULATION_QUEUE_SIZE);
+    queue->itemSize = itemSize;
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+}
+
+static void UnloadSpscQueue(SpscQueue *queue) {
+    free(queue->items);
+    queue->items = NULL;
+}
+
+static bool PushSpscQueue(SpscQueue *queue, const void *item) {
+    int tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    int head = atomic_load_explicit(&queue->head, memory_order_acquire);
+    if (tail - head == SIMULATION_QUEUE_SIZE) return false;
+    memcpy(queue->items + (size_t)(tail & (SIMULATION_QUEUE_SIZE - 1)) * queue->itemSize, item, queue->itemSize);
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+static bool PopSpscQueue(SpscQueue *queue, void *item) {
+    int head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    int tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+    if (head == tail) return false;
+    memcpy(item, queue->items + (size_t)(head & (SIMULATION_QUEUE_SIZE - 1)) * queue->itemSize, queue->itemSize);
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+    return true;
+}
+
+//----------------------------------------------------------------------------------
+// Render states
+//----------------------------------------------------------------------------------
+
+// Grows only when the world outgrew it, steady play copies into the same storage. When an
+// allocation fails the old buffers stay and the capacity with them; the state then carries
+// as many enemies and particles as fit, drawing short rather than through a NULL pointer.
+static void ReserveRenderState(RenderState *state, int enemies, int particles) {
+    if (enemies > state->enemyCapacity) {
+        Enemy *grown = realloc(state->enemies, sizeof(Enemy) * enemies * 2);
+        if (grown) {
+            state->enemies = grown;
+            state->enemyCapacity = enemies * 2;
+        }
+    }
+    if (particles > state->particleCapacity) {
+        int capacity = particles * 2;
+        bool ok = true;
+        float **arrays[5] = {&state->x, &state->y, &state->vx, &state->vy, &state->alpha};
+        for (int a = 0; a < 5; a++) {
+            float *grown = realloc(*arrays[a], sizeof(float) * capacity);
+            if (grown) *arrays[a] = grown;
+            else ok = false;
+        }
+        Color *color = realloc(state->color, sizeof(Color) * capacity);
+        if (color) state->color = color;
+        else ok = false;
+        // Arrays that did grow just have room to spare
+        if (ok) state->particleCapacity = capacity;
+    }
+}
+
+static void UnloadRenderState(RenderState *state) {
+    free(state->enemies);
+    free(state->x);
+    free(state->y);
+    free(state->vx);
+    free(state->vy);
+    free(state->alpha);
+    free(state->color);
+    memset(state, 0, sizeof(*state));
+}
+
+// Fill the back buffer from the world and swap it into the middle
+static void PublishRenderState(Simulation *sim) {
+    const World *world = sim->world;
+    const ParticleSystem *ps = &world->particles;
+    RenderState *state = &sim->states[sim->back];
+    ReserveRenderState(state, world->enemiesActive, ps->count);
+
+    state->time = sim->nextTick - WORLD_DT;
+    state->player = world->player;
+    state->playerExploded = world->playerExploded;
+    state->score = world->score;
+    state->worldTime = world->time;
+    state->laserCount = world->laserPool.count;
+    memcpy(state->lasers, world->lasers, sizeof(Laser) * world->laserPool.count);
+
+    // Enemies killed since the last grid rebuild are still in the pool, only living ones are drawn
+    int enemyCount = 0;
+    for (int i = 0; i < world->enemyPool.count && enemyCount < state->enemyCapacity; i++) {
+        if (world->enemies[i].active) state->enemies[enemyCount++] = world->enemies[i];
+    }
+    state->enemyCount = enemyCount;
+
+    state->particleCount = (ps->count < state->particleCapacity) ? ps->count : state->particleCapacity;
+    if (state->particleCount > 0) {
+        size_t bytes = sizeof(float) * state->particleCount;
+        memcpy(state->x, ps->x, bytes);
+        memcpy(state->y, ps->y, bytes);
+        memcpy(state->vx, ps->vx, bytes);
+        memcpy(state->vy, ps->vy, bytes);
+        memcpy(state->alpha, ps->alpha, bytes);
+        memcpy(state->color, ps->color, sizeof(Color) * state->particleCount);
+    }
+
+    state->enemiesActive = world->enemiesActive;
+    state->replaying = sim->replaying;
+    state->rewindSeconds = sim->rewindEnabled ? GetRewindSeconds(&sim->rewind) : 0.0f;
+    state->rewindBytes = sim->rewindEnabled ? GetRewindBytes(&sim->rewind) : 0;
+    state->totals = sim->totals;
+
+    sim->back = atomic_exchange_explicit(&sim->middle, sim->back | SIMULATION_STATE_FRESH, memory_order_acq_rel) & 3;
+}
+
+const RenderState *GetRenderState(Simulation *sim) {
+    if (atomic_load_explicit(&sim->middle, memory_order_relaxed) & SIMULATION_STATE_FRESH) {
+        sim->front = atomic_exchange_explicit(&sim->middle, sim->front, memory_order_acq_rel) & 3;
+    }
+    return &sim->states[sim->front];
+}
+
+//----------------------------------------------------------------------------------
+// Stepping, on the simulation thread or inline
+//----------------------------------------------------------------------------------
+
+static void ReceiveInputs(Simulation *sim) {
+    SimulationInput message;
+    while (PopSpscQueue(&sim->inputs, &message)) {
+        if (message.press) {
+            PushInputEvent(&sim->pending, message.action, message.time);
+        } else {
+            sim->pending.left = message.held.left;
+            sim->pending.right = message.held.right;
+            sim->pending.up = message.held.up;
+            sim->pending.down = message.held.down;
+            sim->pending.joystick = message.held.joystick;
+            sim->pending.stick = message.held.stick;
+            sim->rewinding = message.rewind;
+            sim->world->fireworkEvery = message.fireworkEvery;
+            sim->world->particleBudget = message.particleBudget;
+        }
+    }
+}
+
+// Run every step due by now and publish the result
+static void RunDueSteps(Simulation *sim, double now) {
+    ReceiveInputs(sim);
+    if (now - sim->nextTick > SIMULATION_MAX_BACKLOG) sim->nextTick = now - SIMULATION_MAX_BACKLOG;
+
+    bool changed = false;
+    World *world = sim->world;
+    while (sim->nextTick <= now) {
+        sim->nextTick += WORLD_DT;
+        changed = true;
+
+        // Holding rewind walks back through the history instead of stepping, play
+        // continues from there on release
+        if (sim->rewindEnabled && sim->rewinding && sim->rewind.count > 1) {
+            if (++sim->restores % REWIND_TICKS_PER_FRAME == 0) RestoreRewind(&sim->rewind, world, 1);
+            continue;
+        }
+
+        GameInputs inputs;
+        TakeStepInputs(&sim->pending, &inputs);
+        if (sim->replaying) {
+            GameInputs recorded;
+            if (ReadRecordedTick(sim->session, &recorded)) inputs = recorded;
+            else sim->replaying = false;    // Out of recorded ticks, live input takes over
+        }
+        if (sim->recording) RecordTick(sim->session, &inputs);
+        StepWorld(world, &inputs, WORLD_DT);
+        if (sim->rewindEnabled) CaptureRewind(&sim->rewind, world);
+
+        SimulationTotals *totals = &sim->totals;
+        totals->steps++;
+        totals->collisionTests += world->collisionTests;
+        for (int p = 0; p < WORLD_PHASE_COUNT; p++) totals->stepTime += world->phaseTime[p];
+        totals->collisionTime += world->phaseTime[PHASE_COLLISIONS];
+        totals->particleTime += world->phaseTime[PHASE_PARTICLES];
+    }
+    if (!changed) return;
+
+    // Publish before handing back the presses, so a press the frontend receives is always
+    // in a state it can already get
+    PublishRenderState(sim);
+    for (int i = 0; i < sim->pending.appliedCount; i++) PushSpscQueue(&sim->presses, &sim->pending.applied[i]);
+    sim->pending.appliedCount = 0;
+}
+
+#if !defined(JOBS_SINGLE_THREADED)
+static void *SimulationThread(void *arg) {
+    Simulation *sim = (Simulation *)arg;
+    // The job system only splits loops submitted from the thread that started it
+    InitJobs(sim->workerCount);
+    while (!atomic_load_explicit(&sim->quit, memory_order_acquire)) {
+        RunDueSteps(sim, sim->clock());
+        double wait = sim->nextTick - sim->clock();
+        if (wait > 0.0) {
+            struct timespec ts = {0, (long)(wait * 1e9)};
+            nanosleep(&ts, NULL);
+        }
+    }
+    CloseJobs();
+    return NULL;
+}
+#endif
+
+void StartSimulation(Simulation *sim, World *world, InputRecording *session, bool recording, bool replaying,
+                     WorldClock clock, int workerCount) {
+    memset(sim, 0, sizeof(*sim));
+    sim->world = world;
+    sim->session = session;
+    sim->recording = recording;
+    sim->replaying = replaying;
+    sim->clock = clock;
+    sim->workerCount = workerCount;
+    sim->fireworkEvery = world->fireworkEvery;
+    sim->particleBudget = world->particleBudget;
+
+    // Last seconds of play for rewind. Off while recording or replaying, whose inputs only
+    // make sense as one unbroken run of ticks.
+    sim->rewindEnabled = !recording && !replaying;
+    if (sim->rewindEnabled) InitRewind(&sim->rewind, 10.0f, 4);
+    InitInput(&sim->pending);
+
+    InitSpscQueue(&sim->inputs, sizeof(SimulationInput));
+    InitSpscQueue(&sim->presses, sizeof(double));
+    sim->front = 0;
+    sim->back = 1;
+    atomic_init(&sim->middle, 2);
+
+    // The reader has a state to draw before the first step
+    sim->nextTick = clock() + WORLD_DT;
+    PublishRenderState(sim);
+    GetRenderState(sim);
+
+#if !defined(JOBS_SINGLE_THREADED)
+    atomic_init(&sim->quit, false);
+    sim->threaded = pthread_create(&sim->thread, NULL, SimulationThread, sim) == 0;
+#endif
+    if (!sim->threaded) InitJobs(workerCount);
+}
+
+void StopSimulation(Simulation *sim) {
+#if !defined(JOBS_SINGLE_THREADED)
+    if (sim->threaded) {
+        atomic_store_explicit(&sim->quit, true, memory_order_release);
+        pthread_join(sim->thread, NULL);
+    }
+#endif
+    if (!sim->threaded) CloseJobs();
+    if (sim->rewindEnabled) UnloadRewind(&sim->rewind);
+    UnloadSpscQueue(&sim->inputs);
+    UnloadSpscQueue(&sim->presses);
+    for (int i = 0; i < 3; i++) UnloadRenderState(&sim->states[i]);
+}
+
+void UpdateSimulation(Simulation *sim) {
+    if (!sim->threaded) RunDueSteps(sim, sim->clock());
+}
+
+void SendSimulationInput(Simulation *sim, InputState *input, bool rewind) {
+    // Presses leave the frontend queue here, a full ring drops them like a full input queue
+    while (input->count > 0) {
+        const InputEvent *event = &input->events[input->head];
+        SimulationInput message = {.press = true, .action = event->action, .time = event->time};
+        if (!PushSpscQueue(&sim->inputs, &message)) input->dropped++;
+        input->head = (input->head + 1) & (INPUT_QUEUE_SIZE - 1);
+        input->count--;
+    }
+    SimulationInput held = {.press = false, .rewind = rewind, .fireworkEvery = sim->fireworkEvery,
+                            .particleBudget = sim->particleBudget};
+    held.held.left = input->left;
+    held.held.right = input->right;
+    held.held.up = input->up;
+    held.held.down = input->down;
+    held.held.joystick = input->joystick;
+    held.held.stick = input->stick;
+    PushSpscQueue(&sim->inputs, &held);
+}
+
+void SetSimulationEffects(Simulation *sim, int fireworkEvery, int particleBudget) {
+    sim->fireworkEvery = fireworkEvery;
+    sim->particleBudget = particleBudget;
+}
+
+void ReceiveSimulationPresses(Simulation *sim, InputState *input) {
+    double time;
+    while (PopSpscQueue(&sim->presses, &time)) {
+        if (input->appliedCount < INPUT_QUEUE_SIZE) input->applied[input->appliedCount++] = time;
+    }
+}
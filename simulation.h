@@ -0,0 +1,121 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "world.h"
+#include "input.h"
+#include "replay.h"
+#include "snapshot.h"
+#include "jobs.h"
+#include <stdatomic.h>
+#if !defined(JOBS_SINGLE_THREADED)
+    #include <pthread.h>
+#endif
+
+// Game simulation on its own thread. It steps the world at WORLD_TICK_RATE by the clock,
+// whatever the frame rate, and after every batch of steps publishes a RenderState: a copy
+// of everything drawing needs. Three states rotate through a lock-free triple buffer, so
+// the simulation never waits for a frame and the frontend always reads the newest
+// complete one. Inputs go the other way through a single producer, single consumer queue,
+// and applied presses come back through a second one for latency tracking.
+// Builds without threads (JOBS_SINGLE_THREADED) run the same steps inline in
+// UpdateSimulation, through the same queues and buffers.
+#define SIMULATION_QUEUE_SIZE 256       // Power of two, messages per direction in flight
+
+// Running totals over every step since StartSimulation; readers diff two states, so states
+// they never saw still count
+typedef struct {
+    long long steps;
+    long long collisionTests;
+    double stepTime;            // Seconds inside StepWorld, zero when the world has no clock
+    double collisionTime;       // PHASE_COLLISIONS part of it
+    double particleTime;        // PHASE_PARTICLES part of it
+} SimulationTotals;
+
+// Everything a frame draws, packed: lasers in flight, living enemies, all particles
+typedef struct {
+    double time;                // Clock time the newest step stands for, frames interpolate from it
+    Spaceship player;
+    bool playerExploded;
+    int score;
+    float worldTime;            // World.time, drives the title color
+    int laserCount;
+    Laser lasers[MAX_LASERS];
+    int enemyCount;
+    int enemyCapacity;
+    Enemy *enemies;
+    int particleCount;
+    int particleCapacity;
+    float *x, *y, *vx, *vy, *alpha;     // Particle arrays, as in ParticleSystem
+    Color *color;
+    int enemiesActive;
+    bool replaying;             // Still playing back a recording
+    float rewindSeconds;
+    int rewindBytes;
+    SimulationTotals totals;
+} RenderState;
+
+// Messages into the simulation: a press, or the held state that every step uses until the next one
+typedef struct {
+    bool press;
+    InputAction action;         // Press only
+    double time;                // Press only, poll time for latency
+    GameInputs held;            // Held state only: fire and restart unused
+    bool rewind;                // Held state only: walk back through the rewind history
+    int fireworkEvery;          // Held state only: World effects settings
+    int particleBudget;
+} SimulationInput;
+
+typedef struct {
+    unsigned char *items;
+    int itemSize;
+    atomic_int head;            // Next item to pop, written by the consumer only
+    atomic_int tail;            // Next free item, written by the producer only
+} SpscQueue;
+
+typedef struct {
+    // Owned by the simulation while it runs
+    World *world;
+    InputRecording *session;    // Recording or replay, NULL when neither
+    bool recording;
+    bool replaying;
+    RewindBuffer rewind;
+    bool rewindEnabled;
+    InputState pending;         // Held state and queued presses received so far
+    bool rewinding;
+    long long restores;         // Ticks spent rewinding
+    WorldClock clock;
+    double nextTick;            // Clock time the next step is due
+    SimulationTotals totals;
+    int workerCount;
+
+    // Triple buffer: the writer fills states[back], the reader draws states[front], and
+    // middle holds the third index, with SIMULATION_STATE_FRESH set while it is newer
+    RenderState states[3];
+    int back;
+    int front;
+    atomic_int middle;
+
+    SpscQueue inputs;           // Frontend to simulation, SimulationInput
+    int fireworkEvery;          // Frontend side, effects settings sent with every held state
+    int particleBudget;
+    SpscQueue presses;          // Simulation to frontend, poll time of each applied press
+
+    bool threaded;              // False without thread support or when the thread failed to start
+#if !defined(JOBS_SINGLE_THREADED)
+    pthread_t thread;
+    atomic_bool quit;
+#endif
+} Simulation;
+
+// Starts stepping world right away. The simulation owns world, session and the job
+// system (started with workerCount helpers) until StopSimulation returns.
+void StartSimulation(Simulation *sim, World *world, InputRecording *session, bool recording, bool replaying,
+                     WorldClock clock, int workerCount);
+void StopSimulation(Simulation *sim);
+void UpdateSimulation(Simulation *sim);                     // Once per frame: steps inline builds, no-op with a thread
+void SendSimulationInput(Simulation *sim, InputState *input, bool rewind);     // After PollInput: hand over presses and held state
+void ReceiveSimulationPresses(Simulation *sim, InputState *input);     // Applied presses for EndInputFrame, call before GetRenderState
+const RenderState *GetRenderState(Simulation *sim);        // Newest complete state, valid until the next call
+void SetSimulationEffects(Simulation *sim, int fireworkEvery, int particleBudget);     // World effects settings, sent with the next input
+
+#endif // SIMULATION_H
@@ -0,0 +1,369 @@
+#include "snapshot.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define REWIND_KEY_INTERVAL 30      // Frames per group, one key frame a second at the default interval
+
+static int Align4(int offset) {
+    return (offset + 3) & ~3;
+}
+
+// Section offsets of a snapshot with the given counts
+typedef struct {
+    int laserSlots;
+    int enemySlots;
+    int enemies;
+    int gridMembers;
+    int blocked;
+    int particles;
+    int size;
+} SnapshotLayout;
+
+static SnapshotLayout GetSnapshotLayout(int laserSlots, int enemySlots, int enemyCount, int flowCells, int particleCount) {
+    SnapshotLayout layout;
+    int slotBytes = (int)(sizeof(int) + sizeof(unsigned int));
+    layout.laserSlots = Align4((int)sizeof(WorldSnapshot));
+    layout.enemySlots = layout.laserSlots + laserSlots * slotBytes;
+    layout.enemies = layout.enemySlots + enemySlots * slotBytes;
+    layout.gridMembers = Align4(layout.enemies + enemyCount * (int)sizeof(Enemy));
+    layout.blocked = Align4(layout.gridMembers + (enemyCount + 7) / 8);
+    layout.particles = Align4(layout.blocked + flowCells);
+    layout.size = layout.particles + particleCount * (6 * (int)sizeof(float) + (int)sizeof(Color));
+    return layout;
+}
+
+int GetWorldSnapshotSize(const World *world) {
+    return GetSnapshotLayout(world->laserPool.slotCount, world->enemyPool.slotCount, world->enemyPool.count,
+                             world->flowField.cols * world->flowField.rows, world->particles.count).size;
+}
+
+int SaveWorldSnapshot(const World *world, void *buffer, int capacity) {
+    int flowCells = world->flowField.cols * world->flowField.rows;
+    int particleCount = world->particles.count;
+    const EntityPool *lasers = &world->laserPool;
+    const EntityPool *enemies = &world->enemyPool;
+    SnapshotLayout layout = GetSnapshotLayout(lasers->slotCount, enemies->slotCount, enemies->count, flowCells, particleCount);
+    if (layout.size > capacity) return 0;
+
+    // Zeroed first so padding bytes are the same in every snapshot and diff to nothing
+    unsigned char *out = buffer;
+    memset(out, 0, layout.size);
+    WorldSnapshot *header = buffer;
+    header->size = layout.size;
+    header->width = world->width;
+    header->height = world->height;
+    header->player = world->player;
+    memcpy(header->lasers, world->lasers, sizeof(world->lasers));
+    header->laserCount = lasers->count;
+    header->laserSlots = lasers->slotCount;
+    header->laserFreeSlot = lasers->freeHead;
+    header->enemyCount = enemies->count;
+    header->enemySlots = enemies->slotCount;
+    header->enemyFreeSlot = enemies->freeHead;
+    header->enemiesActive = world->enemiesActive;
+    header->enemyLimit = world->enemyLimit;
+    header->enemyWave = world->enemyWave;
+    header->director = world->director;
+    header->score = world->score;
+    header->playerExploded = world->playerExploded;
+    header->enemySpawnTimer = world->enemySpawnTimer;
+    header->fireworkTimer = world->fireworkTimer;
+    header->fireworks = world->fireworks;
+    header->time = world->time;
+    header->rng = world->rng;
+    header->flowCells = flowCells;
+    header->particleCount = particleCount;
+
+    SaveEntityPool(lasers, (int *)(out + layout.laserSlots), (unsigned int *)(out + layout.laserSlots) + lasers->slotCount);
+    SaveEntityPool(enemies, (int *)(out + layout.enemySlots), (unsigned int *)(out + layout.enemySlots) + enemies->slotCount);
+    if (enemies->count > 0) memcpy(out + layout.enemies, world->enemies, sizeof(Enemy) * enemies->count);
+
+    // Separation reads last step's grid, which can still hold enemies killed after it was built
+    unsigned char *members = out + layout.gridMembers;
+    const SpatialHash *grid = &world->enemyGrid;
+    for (int i = 0; i < grid->count; i++) members[grid->ids[i] >> 3] |= (unsigned char)(1 << (grid->ids[i] & 7));
+
+    memcpy(out + layout.blocked, world->flowField.blocked, flowCells);
+
+    const ParticleSystem *ps = &world->particles;
+    float *floats = (float *)(out + layout.particles);
+    const float *arrays[6] = {ps->x, ps->y, ps->vx, ps->vy, ps->alpha, ps->life};
+    for (int a = 0; a < 6; a++) {
+        if (particleCount > 0) memcpy(floats + (size_t)a * particleCount, arrays[a], sizeof(float) * particleCount);
+    }
+    if (particleCount > 0) memcpy(floats + (size_t)6 * particleCount, ps->color, sizeof(Color) * particleCount);
+    return layout.size;
+}
+
+bool LoadWorldSnapshot(World *world, const void *snapshot, int size) {
+    WorldSnapshot header;
+    if (size < (int)sizeof(header)) return false;
+    memcpy(&header, snapshot, sizeof(header));
+    int flowCells = world->flowField.cols * world->flowField.rows;
+    if (header.size != size || header.width != world->width || header.height != world->height ||
+        header.flowCells != flowCells || header.laserSlots < 0 || header.laserSlots > world->laserPool.maxCapacity ||
+        header.enemySlots < 0 || header.enemySlots > world->enemyPool.maxCapacity || header.laserCount < 0 ||
+        header.laserCount > header.laserSlots || header.enemyCount < 0 || header.enemyCount > header.enemySlots ||
+        header.particleCount < 0) return false;
+    SnapshotLayout layout = GetSnapshotLayout(header.laserSlots, header.enemySlots, header.enemyCount, flowCells, header.particleCount);
+    if (layout.size != size || !ReserveParticles(&world->particles, header.particleCount)) return false;
+
+    const unsigned char *in = snapshot;
+    int enemyCapacity = world->enemyPool.capacity;
+    const int *laserEntries = (const int *)(in + layout.laserSlots);
+    const int *enemyEntries = (const int *)(in + layout.enemySlots);
+    if (!LoadEntityPool(&world->laserPool, header.laserCount, header.laserSlots, header.laserFreeSlot,
+                        laserEntries, (const unsigned int *)(laserEntries + header.laserSlots)) ||
+        !LoadEntityPool(&world->enemyPool, header.enemyCount, header.enemySlots, header.enemyFreeSlot,
+                        enemyEntries, (const unsigned int *)(enemyEntries + header.enemySlots))) return false;
+    if (world->enemyPool.capacity > enemyCapacity) {
+        Enemy *enemies = realloc(world->enemies, sizeof(Enemy) * world->enemyPool.capacity);
+        if (enemies) world->enemies = enemies;
+        EntityHandle *handles = enemies ? realloc(world->enemyGridHandles, sizeof(EntityHandle) * world->enemyPool.capacity) : NULL;
+        if (handles) world->enemyGridHandles = handles;
+        if (!enemies || !handles) {
+            world->enemyPool.capacity = enemyCapacity;
+            return false;
+        }
+    }
+
+    world->player = header.player;
+    memcpy(world->lasers, header.lasers, sizeof(world->lasers));
+    world->enemiesActive = header.enemiesActive;
+    world->enemyLimit = header.enemyLimit;
+    world->enemyWave = header.enemyWave;
+    world->director = header.director;
+    world->score = header.score;
+    world->playerExploded = header.playerExploded;
+    world->enemySpawnTimer = header.enemySpawnTimer;
+    world->fireworkTimer = header.fireworkTimer;
+    world->fireworks = header.fireworks;
+    world->time = header.time;
+    world->rng = header.rng;
+    if (header.enemyCount > 0) memcpy(world->enemies, in + layout.enemies, sizeof(Enemy) * header.enemyCount);
+
+    // Enemies do not move after the grid is built, so their positions are the grid's points.
+    // Inserting in entry order reproduces the order StepWorld inserted them in.
+    const unsigned char *members = in + layout.gridMembers;
+    BeginSpatialHash(&world->enemyGrid);
+    for (int i = 0; i < header.enemyCount; i++) {
+        if (members[i >> 3] & (1 << (i & 7))) InsertSpatialHash(&world->enemyGrid, i, world->enemies[i].position);
+    }
+    EndSpatialHash(&world->enemyGrid);
+    SyncEnemyGridHandles(world);
+
+    // The field is a function of goal and obstacles, the next step rebuilds it
+    FlowField *field = &world->flowField;
+    memcpy(field->blocked, in + layout.blocked, flowCells);
+    field->blockedCount = 0;
+    for (int i = 0; i < flowCells; i++) field->blockedCount += field->blocked[i];
+    field->dirty = true;
+
+    ParticleSystem *ps = &world->particles;
+    int particleCount = header.particleCount;
+    const float *floats = (const float *)(in + layout.particles);
+    float *arrays[6] = {ps->x, ps->y, ps->vx, ps->vy, ps->alpha, ps->life};
+    for (int a = 0; a < 6; a++) {
+        if (particleCount > 0) memcpy(arrays[a], floats + (size_t)a * particleCount, sizeof(float) * particleCount);
+    }
+    if (particleCount > 0) memcpy(ps->color, floats + (size_t)6 * particleCount, sizeof(Color) * particleCount);
+    ps->count = particleCount;
+    return true;
+}
+
+//----------------------------------------------------------------------------------
+// Rewind ring
+//----------------------------------------------------------------------------------
+
+static void PutFrameBytes(RewindFrame *frame, const unsigned char *bytes, int count) {
+    if (frame->size + count > frame->capacity) {
+        int capacity = frame->capacity ? frame->capacity : 1024;
+        while (capacity < frame->size + count) capacity *= 2;
+        frame->data = realloc(frame->data, capacity);
+        frame->capacity = capacity;
+    }
+    memcpy(frame->data + frame->size, bytes, count);
+    frame->size += count;
+}
+
+static void PutVarint(RewindFrame *frame, unsigned int value) {
+    unsigned char bytes[5];
+    int count = 0;
+    do {
+        bytes[count] = (unsigned char)(value & 0x7f);
+        value >>= 7;
+        if (value) bytes[count] |= 0x80;
+        count++;
+    } while (value);
+    PutFrameBytes(frame, bytes, count);
+}
+
+static unsigned int GetVarint(const unsigned char *data, int *cursor) {
+    unsigned int value = 0;
+    for (int shift = 0;; shift += 7) {
+        unsigned char byte = data[(*cursor)++];
+        value |= (unsigned int)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+}
+
+static unsigned char ReferenceByte(const unsigned char *reference, int referenceSize, int i) {
+    return (i < referenceSize) ? reference[i] : 0;
+}
+
+// XOR against the reference (zeros past its end), then split the 4-byte words into byte
+// planes: the sign and exponent bytes of floats that moved a little still XOR to zero and
+// now sit next to each other. The planes are stored as (zero run, literal run, literals)
+// tokens; literal runs only end at four or more zero bytes, shorter gaps cost less inline.
+static void EncodeFrame(RewindFrame *frame, unsigned char *planes, const unsigned char *raw, int rawSize,
+                        const unsigned char *reference, int referenceSize) {
+    int words = rawSize / 4;
+    for (int w = 0; w < words; w++) {
+        for (int b = 0; b < 4; b++) {
+            int i = w * 4 + b;
+            planes[b * words + w] = raw[i] ^ ReferenceByte(reference, referenceSize, i);
+        }
+    }
+
+    frame->size = 0;
+    frame->rawSize = rawSize;
+    int i = 0;
+    while (i < rawSize) {
+        int zeros = 0;
+        while (i + zeros < rawSize && planes[i + zeros] == 0) zeros++;
+        i += zeros;
+        int literal = 0;
+        int quiet = 0;
+        while (i + literal < rawSize && quiet < 4) {
+            quiet = (planes[i + literal] == 0) ? quiet + 1 : 0;
+            literal++;
+        }
+        if (quiet == 4) literal -= 4;
+        PutVarint(frame, zeros);
+        PutVarint(frame, literal);
+        PutFrameBytes(frame, planes + i, literal);
+        i += literal;
+    }
+}
+
+static void DecodeFrame(const RewindFrame *frame, unsigned char *planes, const unsigned char *reference, int referenceSize, unsigned char *out) {
+    int cursor = 0;
+    int i = 0;
+    while (cursor < frame->size) {
+        int zeros = (int)GetVarint(frame->data, &cursor);
+        memset(planes + i, 0, zeros);
+        i += zeros;
+        int literal = (int)GetVarint(frame->data, &cursor);
+        memcpy(planes + i, frame->data + cursor, literal);
+        cursor += literal;
+        i += literal;
+    }
+
+    int words = frame->rawSize / 4;
+    for (int w = 0; w < words; w++) {
+        for (int b = 0; b < 4; b++) {
+            int k = w * 4 + b;
+            out[k] = planes[b * words + w] ^ ReferenceByte(reference, referenceSize, k);
+        }
+    }
+}
+
+static void ReserveBytes(unsigned char **buffer, int *capacity, int size) {
+    if (size <= *capacity) return;
+    int grown = *capacity ? *capacity : 4096;
+    while (grown < size) grown *= 2;
+    *buffer = realloc(*buffer, grown);
+    *capacity = grown;
+}
+
+void InitRewind(RewindBuffer *rewind, float seconds, int interval) {
+    memset(rewind, 0, sizeof(*rewind));
+    rewind->interval = (interval > 0) ? interval : 1;
+    rewind->keyInterval = REWIND_KEY_INTERVAL;
+    int frames = (int)(seconds * WORLD_TICK_RATE / rewind->interval + 0.5f);
+    int groups = (frames + REWIND_KEY_INTERVAL - 1) / REWIND_KEY_INTERVAL;
+    rewind->frameCount = ((groups > 1) ? groups : 2) * REWIND_KEY_INTERVAL;     // One group is always being overwritten
+    rewind->frames = calloc(rewind->frameCount, sizeof(RewindFrame));
+}
+
+void UnloadRewind(RewindBuffer *rewind) {
+    for (int i = 0; i < rewind->frameCount; i++) free(rewind->frames[i].data);
+    free(rewind->frames);
+    free(rewind->key);
+    free(rewind->scratch);
+    free(rewind->planes);
+    memset(rewind, 0, sizeof(*rewind));
+}
+
+void ClearRewind(RewindBuffer *rewind) {
+    rewind->head = 0;
+    rewind->count = 0;
+    rewind->ticks = 0;
+}
+
+void CaptureRewind(RewindBuffer *rewind, const World *world) {
+    if (rewind->ticks++ % rewind->interval != 0) return;
+
+    int size = GetWorldSnapshotSize(world);
+    ReserveBytes(&rewind->scratch, &rewind->scratchCapacity, size);
+    ReserveBytes(&rewind->planes, &rewind->planesCapacity, size);
+    SaveWorldSnapshot(world, rewind->scratch, size);
+
+    int slot = rewind->head;
+    RewindFrame *frame = &rewind->frames[slot];
+    frame->tick = rewind->ticks - 1;
+    if (slot % rewind->keyInterval == 0) {
+        // New group: the key frame only collapses zero runs, later frames diff against it
+        EncodeFrame(frame, rewind->planes, rewind->scratch, size, NULL, 0);
+        rewind->key = realloc(rewind->key, size);
+        memcpy(rewind->key, rewind->scratch, size);
+        rewind->keySize = size;
+    } else {
+        EncodeFrame(frame, rewind->planes, rewind->scratch, size, rewind->key, rewind->keySize);
+    }
+
+    // Overwriting a key frame takes its whole group with it
+    rewind->head = (slot + 1) % rewind->frameCount;
+    int restorable = rewind->frameCount - rewind->keyInterval + slot % rewind->keyInterval + 1;
+    rewind->count = (rewind->count + 1 < restorable) ? rewind->count + 1 : restorable;
+}
+
+bool RestoreRewind(RewindBuffer *rewind, World *world, int framesBack) {
+    if (framesBack < 0 || framesBack >= rewind->count) return false;
+    int slot = (rewind->head - 1 - framesBack + rewind->frameCount) % rewind->frameCount;
+    int keySlot = slot - slot % rewind->keyInterval;
+    const RewindFrame *keyFrame = &rewind->frames[keySlot];
+    const RewindFrame *frame = &rewind->frames[slot];
+
+    // The key frame becomes the reference for captures after this point again
+    rewind->key = realloc(rewind->key, keyFrame->rawSize);
+    rewind->keySize = keyFrame->rawSize;
+    int planeBytes = (keyFrame->rawSize > frame->rawSize) ? keyFrame->rawSize : frame->rawSize;
+    ReserveBytes(&rewind->planes, &rewind->planesCapacity, planeBytes);
+    DecodeFrame(keyFrame, rewind->planes, NULL, 0, rewind->key);
+
+    const unsigned char *snapshot = rewind->key;
+    if (slot != keySlot) {
+        ReserveBytes(&rewind->scratch, &rewind->scratchCapacity, frame->rawSize);
+        DecodeFrame(frame, rewind->planes, rewind->key, rewind->keySize, rewind->scratch);
+        snapshot = rewind->scratch;
+    }
+    if (!LoadWorldSnapshot(world, snapshot, frame->rawSize)) return false;
+
+    rewind->head = (slot + 1) % rewind->frameCount;
+    rewind->count -= framesBack;
+    rewind->ticks = frame->tick + 1;
+    return true;
+}
+
+int GetRewindBytes(const RewindBuffer *rewind) {
+    int bytes = 0;
+    for (int k = 0; k < rewind->count; k++) {
+        bytes += rewind->frames[(rewind->head - 1 - k + rewind->frameCount) % rewind->frameCount].size;
+    }
+    return bytes;
+}
+
+float GetRewindSeconds(const RewindBuffer *rewind) {
+    return (float)rewind->count * rewind->interval * WORLD_DT;
+}
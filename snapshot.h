@@ -0,0 +1,88 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "world.h"
+
+// World snapshots: everything StepWorld reads, packed into one contiguous block with no
+// pointers, so a snapshot can be memcpy'd, written to disk or diffed byte by byte.
+// Loading one into a world and stepping it gives bit-identical results to the original.
+// Derived state is rebuilt on load: the enemy grid from the stored member list, the flow
+// field from its obstacles on the next step.
+//
+// Layout: this header, then each section starting 4-byte aligned
+//   i32 entry[laserSlots], u32 generation[laserSlots]     laser pool slots
+//   i32 entry[enemySlots], u32 generation[enemySlots]     enemy pool slots
+//   Enemy enemies[enemyCount]
+//   u8 gridMembers[(enemyCount + 7) / 8]   bit i set when enemy i is in the separation grid
+//   u8 blocked[flowCells]                  flow field obstacles
+//   f32 x, y, vx, vy, alpha, life [particleCount] each, then Color color[particleCount]
+typedef struct {
+    int size;                           // Whole snapshot in bytes
+    int width;
+    int height;
+    Spaceship player;
+    Laser lasers[MAX_LASERS];
+    int laserCount;
+    int laserSlots;
+    int laserFreeSlot;
+    int enemyCount;
+    int enemySlots;
+    int enemyFreeSlot;
+    int enemiesActive;
+    int enemyLimit;
+    int enemyWave;
+    WaveDirector director;
+    int score;
+    bool playerExploded;
+    float enemySpawnTimer;
+    float fireworkTimer;
+    int fireworks;
+    float time;
+    unsigned int rng;
+    int flowCells;
+    int particleCount;
+} WorldSnapshot;
+
+int GetWorldSnapshotSize(const World *world);
+int SaveWorldSnapshot(const World *world, void *buffer, int capacity);     // Bytes written, 0 when capacity is too small
+bool LoadWorldSnapshot(World *world, const void *snapshot, int size);      // world from InitWorld with the same playfield size
+
+// Rewind history: a ring of snapshots taken every few ticks over the last few seconds.
+// Every frame is stored as the XOR against its group's key frame, split into byte planes
+// with zero runs collapsed, so state that did not change costs almost nothing and state
+// that moved a little keeps only its low mantissa bytes. A key frame
+// starts each group of keyInterval frames, and any frame restores from its key frame plus
+// itself alone, whatever its age.
+typedef struct {
+    int tick;                   // RewindBuffer.ticks when it was captured
+    int rawSize;                // Snapshot size before encoding
+    int size;                   // Encoded bytes
+    int capacity;
+    unsigned char *data;
+} RewindFrame;
+
+typedef struct {
+    RewindFrame *frames;        // Ring, slots at multiples of keyInterval hold key frames
+    int frameCount;
+    int keyInterval;
+    int interval;               // Ticks between captures
+    int head;                   // Slot of the next capture
+    int count;                  // Restorable frames, newest at head - 1
+    int ticks;                  // Steps seen by CaptureRewind
+    unsigned char *key;         // Decoded key frame of the group being written
+    int keySize;
+    unsigned char *scratch;     // Snapshot being encoded or decoded
+    int scratchCapacity;
+    unsigned char *planes;      // Its XOR byte planes
+    int planesCapacity;
+} RewindBuffer;
+
+void InitRewind(RewindBuffer *rewind, float seconds, int interval);    // seconds of history at WORLD_TICK_RATE
+void UnloadRewind(RewindBuffer *rewind);
+void ClearRewind(RewindBuffer *rewind);
+void CaptureRewind(RewindBuffer *rewind, const World *world);     // After every StepWorld, keeps each interval-th
+bool RestoreRewind(RewindBuffer *rewind, World *world, int framesBack);    // 0 is the newest frame; newer ones are dropped
+int GetRewindBytes(const RewindBuffer *rewind);         // Encoded bytes of the restorable frames
+float GetRewindSeconds(const RewindBuffer *rewind);     // Simulated time they cover
+
+#endif // SNAPSHOT_H
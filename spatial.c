@@ -0,0 +1,169 @@
+#include "spatial.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define SPATIAL_MIN_TABLE_BITS 4
+
+void InitSpatialHash(SpatialHash *hash) {
+    memset(hash, 0, sizeof(*hash));
+}
+
+void UnloadSpatialHash(SpatialHash *hash) {
+    free(hash->bucketStart);
+    free(hash->keys);
+    free(hash->ids);
+    free(hash->points);
+    free(hash->scratchKeys);
+    free(hash->scratchIds);
+    free(hash->scratchPoints);
+    free(hash->results);
+    memset(hash, 0, sizeof(*hash));
+}
+
+void ResizeSpatialHash(SpatialHash *hash, int width, int height, float cellSize) {
+    hash->cellSize = cellSize;
+    hash->invCellSize = 1.0f / cellSize;
+    hash->cols = (int)ceilf(width / cellSize) + 1;
+    hash->rows = (int)ceilf(height / cellSize) + 1;
+    hash->count = 0;
+}
+
+static int CellCoord(float value, float invCellSize, int limit) {
+    int c = (int)floorf(value * invCellSize);
+    return (c < 0) ? 0 : (c >= limit) ? limit - 1 : c;
+}
+
+static int BucketOf(const SpatialHash *hash, int key) {
+    return (int)(((unsigned int)key * 2654435761u) >> (32 - hash->tableBits));
+}
+
+void BeginSpatialHash(SpatialHash *hash) {
+    hash->count = 0;
+    hash->tests = 0;
+}
+
+void InsertSpatialHash(SpatialHash *hash, int id, Vector2 point) {
+    if (hash->count == hash->capacity) {
+        int capacity = hash->capacity ? hash->capacity * 2 : 64;
+        hash->keys = realloc(hash->keys, sizeof(int) * capacity);
+        hash->ids = realloc(hash->ids, sizeof(int) * capacity);
+        hash->points = realloc(hash->points, sizeof(Vector2) * capacity);
+        hash->scratchKeys = realloc(hash->scratchKeys, sizeof(int) * capacity);
+        hash->scratchIds = realloc(hash->scratchIds, sizeof(int) * capacity);
+        hash->scratchPoints = realloc(hash->scratchPoints, sizeof(Vector2) * capacity);
+        hash->capacity = capacity;
+    }
+    int i = hash->count++;
+    hash->scratchKeys[i] = CellCoord(point.y, hash->invCellSize, hash->rows) * hash->cols + CellCoord(point.x, hash->invCellSize, hash->cols);
+    hash->scratchIds[i] = id;
+    hash->scratchPoints[i] = point;
+}
+
+void EndSpatialHash(SpatialHash *hash) {
+    // About two buckets per point keeps chains short
+    int bits = SPATIAL_MIN_TABLE_BITS;
+    while ((1 << bits) < hash->count * 2) bits++;
+    hash->tableBits = bits;
+    int buckets = 1 << bits;
+    if (buckets + 1 > hash->bucketCapacity) {
+        free(hash->bucketStart);
+        hash->bucketStart = malloc(sizeof(int) * (buckets + 1));
+        hash->bucketCapacity = buckets + 1;
+    }
+    int *start = hash->bucketStart;
+    memset(start, 0, sizeof(int) * (buckets + 1));
+
+    // Count points per bucket, prefix sum, then scatter; insertion order is kept per bucket
+    for (int i = 0; i < hash->count; i++) start[BucketOf(hash, hash->scratchKeys[i]) + 1]++;
+    for (int b = 0; b < buckets; b++) start[b + 1] += start[b];
+    for (int i = 0; i < hash->count; i++) {
+        int slot = start[BucketOf(hash, hash->scratchKeys[i])]++;
+        hash->keys[slot] = hash->scratchKeys[i];
+        hash->ids[slot] = hash->scratchIds[i];
+        hash->points[slot] = hash->scratchPoints[i];
+    }
+
+    // Scatter advanced each start to the next bucket's start, shift back
+    for (int b = buckets; b > 0; b--) start[b] = start[b - 1];
+    start[0] = 0;
+}
+
+int QuerySpatialHashBuffer(const SpatialHash *hash, Vector2 center, float radius, int *ids, int maxIds, int *tests) {
+    if (hash->count == 0) return 0;
+
+    int x0 = CellCoord(center.x - radius, hash->invCellSize, hash->cols);
+    int x1 = CellCoord(center.x + radius, hash->invCellSize, hash->cols);
+    int y0 = CellCoord(center.y - radius, hash->invCellSize, hash->rows);
+    int y1 = CellCoord(center.y + radius, hash->invCellSize, hash->rows);
+    float radiusSqr = radius * radius;
+    int found = 0;
+    int checked = 0;
+
+    for (int y = y0; y <= y1; y++) {
+        for (int x = x0; x <= x1; x++) {
+            int key = y * hash->cols + x;
+            int bucket = BucketOf(hash, key);
+            for (int i = hash->bucketStart[bucket]; i < hash->bucketStart[bucket + 1]; i++) {
+                if (hash->keys[i] != key) continue;     // Another cell sharing the bucket
+                checked++;
+                float dx = hash->points[i].x - center.x;
+                float dy = hash->points[i].y - center.y;
+                if (dx * dx + dy * dy > radiusSqr) continue;
+
+                // Insertion sort keeps ids ascending, matching a brute-force index loop
+                int k = found++;
+                if (k >= maxIds) continue;
+                int id = hash->ids[i];
+                while (k > 0 && ids[k - 1] > id) {
+                    ids[k] = ids[k - 1];
+                    k--;
+                }
+                ids[k] = id;
+            }
+        }
+    }
+
+    if (tests) *tests += checked;
+    return found;
+}
+
+int QuerySpatialHashPoints(const SpatialHash *hash, Vector2 center, float radius, int *ids, Vector2 *points, int maxCount) {
+    if (hash->count == 0) return 0;
+
+    int x0 = CellCoord(center.x - radius, hash->invCellSize, hash->cols);
+    int x1 = CellCoord(center.x + radius, hash->invCellSize, hash->cols);
+    int y0 = CellCoord(center.y - radius, hash->invCellSize, hash->rows);
+    int y1 = CellCoord(center.y + radius, hash->invCellSize, hash->rows);
+    float radiusSqr = radius * radius;
+    int found = 0;
+
+    for (int y = y0; y <= y1; y++) {
+        for (int x = x0; x <= x1; x++) {
+            int key = y * hash->cols + x;
+            int bucket = BucketOf(hash, key);
+            for (int i = hash->bucketStart[bucket]; i < hash->bucketStart[bucket + 1]; i++) {
+                if (hash->keys[i] != key) continue;
+                float dx = hash->points[i].x - center.x;
+                float dy = hash->points[i].y - center.y;
+                if (dx * dx + dy * dy > radiusSqr) continue;
+                ids[found] = hash->ids[i];
+                points[found] = hash->points[i];
+                if (++found == maxCount) return found;
+            }
+        }
+    }
+
+    return found;
+}
+
+int QuerySpatialHash(SpatialHash *hash, Vector2 center, float radius, const int **ids) {
+    int found = QuerySpatialHashBuffer(hash, center, radius, hash->results, hash->resultCapacity, &hash->tests);
+    if (found > hash->resultCapacity) {
+        while (hash->resultCapacity < found) hash->resultCapacity = hash->resultCapacity ? hash->resultCapacity * 2 : 32;
+        hash->results = realloc(hash->results, sizeof(int) * hash->resultCapacity);
+        found = QuerySpatialHashBuffer(hash, center, radius, hash->results, hash->resultCapacity, NULL);
+    }
+    *ids = hash->results;
+    return found;
+}
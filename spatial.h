@@ -0,0 +1,47 @@
+#ifndef SPATIAL_H
+#define SPATIAL_H
+
+#include "raylib.h"
+
+// Uniform grid spatial hash over the playfield, rebuilt every tick.
+// Grid cells are hashed into a bucket table sized from the point count, so a rebuild
+// costs O(points) whatever the window size. Buckets are filled with a counting sort.
+typedef struct {
+    float cellSize;
+    float invCellSize;
+    int cols;           // Grid size, cell key = row * cols + col
+    int rows;
+    int tableBits;      // Bucket table holds 1 << tableBits buckets
+    int *bucketStart;   // (1 << tableBits) + 1 offsets into keys/ids/points
+    int bucketCapacity;
+    int *keys;          // Cell key of each point, sorted by bucket after EndSpatialHash
+    int *ids;           // Matching ids
+    Vector2 *points;    // Matching positions
+    int *scratchKeys;   // Build scratch, insertion order
+    int *scratchIds;
+    Vector2 *scratchPoints;
+    int count;
+    int capacity;
+    int *results;       // Query output buffer, grows as needed
+    int resultCapacity;
+    int tests;          // Distance checks made by QuerySpatialHash since BeginSpatialHash
+} SpatialHash;
+
+void InitSpatialHash(SpatialHash *hash);
+void UnloadSpatialHash(SpatialHash *hash);
+void ResizeSpatialHash(SpatialHash *hash, int width, int height, float cellSize);
+void BeginSpatialHash(SpatialHash *hash);
+void InsertSpatialHash(SpatialHash *hash, int id, Vector2 point);
+void EndSpatialHash(SpatialHash *hash);
+int QuerySpatialHash(SpatialHash *hash, Vector2 center, float radius, const int **ids);  // Ids within radius, ascending
+
+// Thread-safe variant writing into the caller's buffer. Returns the total number of hits;
+// when that exceeds maxIds only part of them was stored and the query should be repeated.
+// The number of distance checks made is added to *tests when it is not NULL.
+int QuerySpatialHashBuffer(const SpatialHash *hash, Vector2 center, float radius, int *ids, int maxIds, int *tests);
+
+// Ids and stored positions within radius in bucket order, at most maxCount of them.
+// Reads only the grid's own snapshot, so it is safe while the indexed entities move.
+int QuerySpatialHashPoints(const SpatialHash *hash, Vector2 center, float radius, int *ids, Vector2 *points, int maxCount);
+
+#endif // SPATIAL_H
@@ -0,0 +1,156 @@
+// Web startup report for the wasm builds, run in node:
+//   node startup.js [-r repeats] index.wasm [index.simd.wasm ...]
+// For each wasm (and the .js glue next to it) prints the bytes a browser transfers raw,
+// gzip -9 and brotli -11, then the startup work the build controls: streaming compile from
+// an application/wasm response and instantiation against stub imports, median of repeats.
+// The first frame itself needs WebGL; the game logs it in the browser console as
+// "STARTUP: first frame after N ms", counted from navigation start.
+'use strict';
+const fs = require('fs');
+const zlib = require('zlib');
+
+function readLeb(bytes, offset) {
+    let result = 0, shift = 0, byte;
+    do {
+        byte = bytes[offset++];
+        result += (byte & 0x7f) * 2 ** shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return [result, offset];
+}
+
+// Import section walk for what WebAssembly.Module.imports leaves out: memory limits and
+// global types, so the stubs are accepted whatever the build settings were
+function importDetails(bytes) {
+    const details = [];
+    let offset = 8;
+    while (offset < bytes.length) {
+        const id = bytes[offset];
+        let size;
+        [size, offset] = readLeb(bytes, offset + 1);
+        if (id !== 2) {
+            offset += size;
+            continue;
+        }
+        let count, p = offset;
+        [count, p] = readLeb(bytes, p);
+        for (let i = 0; i < count; i++) {
+            let length;
+            [length, p] = readLeb(bytes, p);
+            p += length;
+            [length, p] = readLeb(bytes, p);
+            p += length;
+            const kind = bytes[p++];
+            const entry = {kind};
+            if (kind === 0) {
+                [, p] = readLeb(bytes, p);
+            } else if (kind === 1) {
+                p++;
+                const flags = bytes[p++];
+                [, p] = readLeb(bytes, p);
+                if (flags & 1) [, p] = readLeb(bytes, p);
+            } else if (kind === 2) {
+                const flags = bytes[p++];
+                [entry.initial, p] = readLeb(bytes, p);
+                if (flags & 1) [entry.maximum, p] = readLeb(bytes, p);
+                entry.shared = (flags & 2) !== 0;
+            } else if (kind === 3) {
+                entry.type = {0x7f: 'i32', 0x7e: 'i64', 0x7d: 'f32', 0x7c: 'f64'}[bytes[p++]];
+                entry.mutable = bytes[p++] === 1;
+            }
+            details.push(entry);
+        }
+        break;
+    }
+    return details;
+}
+
+function stubImports(module, bytes) {
+    const details = importDetails(bytes);
+    const imports = {};
+    WebAssembly.Module.imports(module).forEach((entry, i) => {
+        const detail = details[i] || {};
+        let value;
+        if (entry.kind === 'function') {
+            value = () => 0;
+        } else if (entry.kind === 'memory') {
+            value = new WebAssembly.Memory({initial: detail.initial, maximum: detail.maximum ?? 65536, shared: detail.shared});
+        } else if (entry.kind === 'table') {
+            value = new WebAssembly.Table({initial: 4096, element: 'anyfunc'});
+        } else {
+            value = new WebAssembly.Global({value: detail.type || 'i32', mutable: detail.mutable}, detail.type === 'i64' ? 0n : 0);
+        }
+        (imports[entry.module] ??= {})[entry.name] = value;
+    });
+    return imports;
+}
+
+function transferred(bytes) {
+    if (bytes.length === 0) return {raw: 0, gzip: 0, brotli: 0};
+    return {
+        raw: bytes.length,
+        gzip: zlib.gzipSync(bytes, {level: 9}).length,
+        brotli: zlib.brotliCompressSync(bytes, {params: {[zlib.constants.BROTLI_PARAM_QUALITY]: 11}}).length,
+    };
+}
+
+function median(values) {
+    const sorted = [...values].sort((a, b) => a - b);
+    return sorted[sorted.length >> 1];
+}
+
+async function report(wasmPath, repeats) {
+    const wasm = fs.readFileSync(wasmPath);
+    // Glue, plus the pthread worker script of older emscripten releases
+    const jsPaths = ['.js', '.worker.js'].map((suffix) => wasmPath.replace(/\.wasm$/, suffix)).filter((p) => fs.existsSync(p));
+    const jsFiles = jsPaths.map((p) => transferred(fs.readFileSync(p)));
+    const compile = [], instantiate = [];
+    for (let r = 0; r < repeats; r++) {
+        let start = performance.now();
+        const response = new Response(wasm, {headers: {'Content-Type': 'application/wasm'}});
+        const module = await WebAssembly.compileStreaming(response);
+        compile.push(performance.now() - start);
+        const imports = stubImports(module, wasm);
+        start = performance.now();
+        await WebAssembly.instantiate(module, imports);
+        instantiate.push(performance.now() - start);
+    }
+    const w = transferred(wasm);
+    const j = jsFiles.reduce((sum, t) => ({raw: sum.raw + t.raw, gzip: sum.gzip + t.gzip, brotli: sum.brotli + t.brotli}),
+                             {raw: 0, gzip: 0, brotli: 0});
+    return {
+        build: wasmPath,
+        wasm: w,
+        js: j,
+        total_brotli: w.brotli + j.brotli,
+        compile_ms: +median(compile).toFixed(2),
+        instantiate_ms: +median(instantiate).toFixed(2),
+    };
+}
+
+async function main() {
+    const args = process.argv.slice(2);
+    let repeats = 5;
+    const paths = [];
+    for (let i = 0; i < args.length; i++) {
+        if (args[i] === '-r' && i + 1 < args.length) repeats = Math.max(1, parseInt(args[++i], 10));
+        else paths.push(args[i]);
+    }
+    if (paths.length === 0) {
+        console.error('usage: node startup.js [-r repeats] index.wasm [index.simd.wasm ...]');
+        process.exit(1);
+    }
+    for (const path of paths) {
+        if (!fs.existsSync(path)) continue;
+        const r = await report(path, repeats);
+        console.log(`${r.build}: wasm ${r.wasm.raw} B (gzip ${r.wasm.gzip}, brotli ${r.wasm.brotli}), ` +
+                    `js ${r.js.raw} B (gzip ${r.js.gzip}, brotli ${r.js.brotli}), ` +
+                    `compile ${r.compile_ms} ms, instantiate ${r.instantiate_ms} ms`);
+        console.log(JSON.stringify(r));
+    }
+}
+
+main().catch((error) => {
+    console.error(error.message);
+    process.exit(1);
+});
@@ -0,0 +1,41 @@
+#include "viewport.h"
+#include <math.h>
+
+void InitViewport(Viewport *viewport, int worldWidth, int worldHeight, ViewportPolicy policy) {
+    viewport->policy = policy;
+    viewport->worldWidth = worldWidth;
+    viewport->worldHeight = worldHeight;
+    viewport->screenWidth = 0;
+    viewport->screenHeight = 0;
+    viewport->camera = (Camera2D){{0.0f, 0.0f}, {0.0f, 0.0f}, 0.0f, 1.0f};
+    viewport->screenRect = (Rectangle){0};
+}
+
+void UpdateViewport(Viewport *viewport, int screenWidth, int screenHeight) {
+    if (screenWidth == viewport->screenWidth && screenHeight == viewport->screenHeight) return;
+    viewport->screenWidth = screenWidth;
+    viewport->screenHeight = screenHeight;
+
+    // Largest uniform scale that fits the whole playfield, centered
+    float scale = fminf((float)screenWidth / viewport->worldWidth, (float)screenHeight / viewport->worldHeight);
+    float width = viewport->worldWidth * scale;
+    float height = viewport->worldHeight * scale;
+    viewport->screenRect = (Rectangle){floorf((screenWidth - width) / 2.0f), floorf((screenHeight - height) / 2.0f), width, height};
+    viewport->camera.offset = (Vector2){viewport->screenRect.x, viewport->screenRect.y};
+    viewport->camera.target = (Vector2){0.0f, 0.0f};
+    viewport->camera.rotation = 0.0f;
+    viewport->camera.zoom = scale;
+}
+
+void BeginViewport(const Viewport *viewport) {
+    BeginMode2D(viewport->camera);
+    if (viewport->policy == VIEWPORT_LETTERBOX) {
+        const Rectangle *r = &viewport->screenRect;
+        BeginScissorMode((int)r->x, (int)r->y, (int)ceilf(r->width), (int)ceilf(r->height));
+    }
+}
+
+void EndViewport(const Viewport *viewport) {
+    if (viewport->policy == VIEWPORT_LETTERBOX) EndScissorMode();
+    EndMode2D();
+}
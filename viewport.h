@@ -0,0 +1,28 @@
+#ifndef VIEWPORT_H
+#define VIEWPORT_H
+
+#include "raylib.h"
+
+// Maps the fixed logical playfield onto the window. A resize only recomputes the camera,
+// entity positions never change with the window size.
+typedef enum {
+    VIEWPORT_LETTERBOX = 0,     // Uniform scale to fit, the bars outside the playfield are clipped
+    VIEWPORT_EXTEND,            // Same scale, but whatever flies past the playfield edges stays visible
+} ViewportPolicy;
+
+typedef struct {
+    ViewportPolicy policy;
+    int worldWidth;             // Logical playfield size
+    int worldHeight;
+    int screenWidth;            // Window size the camera was computed for
+    int screenHeight;
+    Camera2D camera;            // World to screen transform
+    Rectangle screenRect;       // Playfield area on screen, in pixels
+} Viewport;
+
+void InitViewport(Viewport *viewport, int worldWidth, int worldHeight, ViewportPolicy policy);
+void UpdateViewport(Viewport *viewport, int screenWidth, int screenHeight);    // O(1), call once per frame
+void BeginViewport(const Viewport *viewport);      // Draw in world units until EndViewport
+void EndViewport(const Viewport *viewport);
+
+#endif // VIEWPORT_H
@@ -0,0 +1,463 @@
+#include "world.h"
+#include "jobs.h"
+#include "fastmath.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Crowd members considered per enemy and step: the first ones the grid finds within
+// ENEMY_SEPARATION in bucket order, not the closest, and the enemy itself takes one
+#define MAX_SEPARATION_NEIGHBOURS 16
+#define FLOW_FIELD_MIN_ENEMIES 64      // Below this, and without obstacles, a beeline is cheaper than the field
+#define SEPARATION_WEIGHT 1.5f         // Push apart strength relative to the flow direction
+
+// Entities per job; phases with fewer entities than this run inline on the calling thread
+#define WORLD_JOB_GRAIN 256
+#define MAX_LASER_HITS 8        // Hits stored per laser by the parallel query, more fall back to a requery
+
+// State shared by the parallel phases of one StepWorld. Each job only writes the entities
+// in its own range, everything that touches shared state (score, RNG, particles) is applied
+// afterwards on the calling thread in entity order, so results match a sequential step.
+typedef struct {
+    World *world;
+    float frames;
+    bool useFlowField;
+    int hitCount[MAX_LASERS];
+    int hits[MAX_LASERS][MAX_LASER_HITS];
+    int tests[MAX_LASERS];      // Distance checks per laser query
+} StepContext;
+
+int WorldRandom(World *world) {
+    // xorshift32, one state per world so worlds can step on different threads
+    unsigned int x = world->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    world->rng = x;
+    return (int)(x >> 1);
+}
+
+// Spawn count particles at position flying out in random directions. Sparks that are not
+// shown, over the particle budget or past the store's limit still draw their random
+// numbers, so effects settings never change how the game plays out.
+static void SpawnExplosion(World *world, Vector2 position, int count, Color color, bool shown) {
+    for (int k = 0; k < count; k++) {
+        Vector2 direction;
+        FastDirection((float)(WorldRandom(world) % 360), &direction.x, &direction.y);
+        float speed = (WorldRandom(world) % 5) + 1;
+        if (!shown || world->particles.count >= world->particleBudget) continue;
+        SpawnParticle(&world->particles, position, (Vector2){speed * direction.x, speed * direction.y}, color);
+    }
+}
+
+void AdvanceLasers(Laser *lasers, int count, float frames, int width, int height) {
+    for (int i = 0; i < count; i++) {
+        if (lasers[i].active) {
+            lasers[i].position.x += lasers[i].speed * frames * lasers[i].direction.x;
+            lasers[i].position.y += lasers[i].speed * frames * lasers[i].direction.y;
+            if (lasers[i].position.x < 0 || lasers[i].position.x > width ||
+                lasers[i].position.y < 0 || lasers[i].position.y > height) {
+                lasers[i].active = false;
+            }
+        }
+    }
+}
+
+static void UpdateLaserRange(void *data, int begin, int end) {
+    StepContext *ctx = (StepContext *)data;
+    AdvanceLasers(ctx->world->lasers + begin, end - begin, ctx->frames, ctx->world->width, ctx->world->height);
+}
+
+// Follow the flow field and push away from neighbours. Neighbours come from the grid
+// built at the end of the last step, which still holds every enemy's current position,
+// so no enemy reads another one that may be moving on a different thread.
+static void UpdateEnemyRange(void *data, int begin, int end) {
+    StepContext *ctx = (StepContext *)data;
+    const World *world = ctx->world;
+    const FlowField *field = &world->flowField;
+    Enemy *enemies = world->enemies;
+    Vector2 target = world->player.position;
+    int ids[MAX_SEPARATION_NEIGHBOURS];
+    Vector2 points[MAX_SEPARATION_NEIGHBOURS];
+
+    for (int i = begin; i < end; i++) {
+        if (!enemies[i].active) continue;
+        Vector2 position = enemies[i].position;
+        enemies[i].prevPosition = position;
+
+        // Next to the player, or cut off from it, the field has nothing better than a beeline
+        Vector2 direction = {0.0f, 0.0f};
+        bool beeline = true;
+        if (ctx->useFlowField) {
+            int cell = GetFlowFieldCell(field, position);
+            direction = field->direction[cell];
+            beeline = field->distance[cell] <= FLOW_DIAGONAL_COST || (direction.x == 0.0f && direction.y == 0.0f);
+        }
+        if (beeline) {
+            direction = (Vector2){target.x - position.x, target.y - position.y};
+            float length = sqrtf(direction.x * direction.x + direction.y * direction.y);
+            if (length > 0) {
+                direction.x /= length;
+                direction.y /= length;
+            }
+        }
+
+        // Separation falls off linearly to zero at ENEMY_SEPARATION. The grid is from the last
+        // step, so its ids are resolved through the handles taken when it was built.
+        Vector2 push = {0.0f, 0.0f};
+        int count = QuerySpatialHashPoints(&world->enemyGrid, position, ENEMY_SEPARATION, ids, points, MAX_SEPARATION_NEIGHBOURS);
+        for (int k = 0; k < count; k++) {
+            int j = ResolveEntity(&world->enemyPool, world->enemyGridHandles[ids[k]]);
+            if (j < 0 || j == i || !enemies[j].active) continue;
+            float dx = position.x - points[k].x;
+            float dy = position.y - points[k].y;
+            float distanceSqr = dx * dx + dy * dy;
+            if (distanceSqr <= 1e-6f) {
+                // Exactly stacked, split by entry order so the pair moves apart
+                dx = (i < j) ? -1.0f : 1.0f;
+                dy = 0.0f;
+                distanceSqr = 1.0f;
+            }
+            float distance = sqrtf(distanceSqr);
+            float weight = (1.0f - distance / ENEMY_SEPARATION) / distance;
+            if (weight > 0.0f) {
+                push.x += dx * weight;
+                push.y += dy * weight;
+            }
+        }
+
+        Vector2 velocity = {direction.x + push.x * SEPARATION_WEIGHT, direction.y + push.y * SEPARATION_WEIGHT};
+        float speed = sqrtf(velocity.x * velocity.x + velocity.y * velocity.y);
+        if (speed > 1.0f) {
+            velocity.x /= speed;
+            velocity.y /= speed;
+        }
+        enemies[i].position.x += velocity.x * enemies[i].speed * ctx->frames;
+        enemies[i].position.y += velocity.y * enemies[i].speed * ctx->frames;
+    }
+}
+
+// How many of count more enemies fit under the limit and the storage cap
+static int EnemyRoom(const World *world, int count) {
+    int room = world->enemyLimit - world->enemiesActive;
+    int free = world->enemyPool.maxCapacity - world->enemyPool.count;
+    if (room > free) room = free;
+    return (count < room) ? count : (room > 0) ? room : 0;
+}
+
+// Grow storage once for a whole batch, new enemies go to the end of the packed array.
+// Returns how many were added, fewer than count when storage could not grow.
+static int AddEnemies(World *world, const Vector2 *positions, int count) {
+    EntityPool *pool = &world->enemyPool;
+    if (pool->count + count > pool->capacity) {
+        int capacity = pool->capacity;
+        if (ReserveEntityPool(pool, pool->count + count)) {
+            Enemy *enemies = realloc(world->enemies, sizeof(Enemy) * pool->capacity);
+            if (enemies) world->enemies = enemies;
+            EntityHandle *handles = enemies ? realloc(world->enemyGridHandles, sizeof(EntityHandle) * pool->capacity) : NULL;
+            if (handles) world->enemyGridHandles = handles;
+            // The arrays may stay larger, only capacity has to match what all of them hold
+            if (!enemies || !handles) pool->capacity = capacity;
+        }
+    }
+    int added = 0;
+    for (; added < count; added++) {
+        int i = AcquireEntity(pool);
+        if (i < 0) break;
+        Enemy *enemy = &world->enemies[i];
+        enemy->position = positions[added];
+        enemy->speed = 2.0f;
+        enemy->active = true;
+        enemy->prevPosition = enemy->position;
+    }
+    world->enemiesActive += added;
+    return added;
+}
+
+int SpawnEnemies(World *world, int count) {
+    count = EnemyRoom(world, count);
+    Vector2 spots[DIRECTOR_TICK_BUDGET];
+    int done = 0;
+    while (done < count) {
+        int batch = (count - done < DIRECTOR_TICK_BUDGET) ? count - done : DIRECTOR_TICK_BUDGET;
+        for (int k = 0; k < batch; k++) spots[k] = PickSpawnSpot(&world->director, world->player.position, &world->rng);
+        int added = AddEnemies(world, spots, batch);
+        done += added;
+        if (added < batch) break;
+    }
+    return done;
+}
+
+// Single enemy waves scatter as they always have, bigger ones take turns at every pattern
+static SpawnPattern WavePattern(const World *world) {
+    if (world->enemyWave <= 1) return SPAWN_SCATTER;
+    return (SpawnPattern)(world->director.waves % SPAWN_PATTERN_COUNT);
+}
+
+// Place this tick's share of the due spawn orders. Once the crowd is at its limit the rest
+// of the due orders are dropped, a wave only tops the crowd up.
+static void SpawnDirected(World *world) {
+    Vector2 spots[DIRECTOR_TICK_BUDGET];
+    int count = AdvanceWaveDirector(&world->director, world->player.position, &world->rng, spots,
+                                    EnemyRoom(world, DIRECTOR_TICK_BUDGET));
+    // Out of storage counts as full, the spots that did not fit are dropped
+    if (AddEnemies(world, spots, count) < count || EnemyRoom(world, 1) == 0) CancelDueSpawns(&world->director);
+}
+
+void SyncEnemyGridHandles(World *world) {
+    for (int i = 0; i < world->enemyPool.count; i++) world->enemyGridHandles[i] = GetEntityHandle(&world->enemyPool, i);
+}
+
+void DespawnEnemy(World *world, int index) {
+    if (world->enemies[index].active) world->enemiesActive--;
+    world->enemies[index] = world->enemies[ReleaseEntity(&world->enemyPool, index)];
+}
+
+// Broad-phase only: gather the enemies each laser touches, kills are applied in StepWorld
+static void QueryLaserRange(void *data, int begin, int end) {
+    StepContext *ctx = (StepContext *)data;
+    const Laser *lasers = ctx->world->lasers;
+    for (int i = begin; i < end; i++) {
+        ctx->tests[i] = 0;
+        ctx->hitCount[i] = lasers[i].active ? QuerySpatialHashBuffer(&ctx->world->enemyGrid, lasers[i].position, ENEMY_RADIUS, ctx->hits[i], MAX_LASER_HITS, &ctx->tests[i]) : 0;
+    }
+}
+
+// Charge the time since *mark to phase and move the mark, no-op without a clock
+static void EndPhase(World *world, WorldPhase phase, double *mark) {
+    if (!world->clock) return;
+    double now = world->clock();
+    world->phaseTime[phase] = now - *mark;
+    *mark = now;
+}
+
+void InitWorld(World *world, int width, int height, unsigned int seed) {
+    memset(world, 0, sizeof(*world));
+    world->width = width;
+    world->height = height;
+    world->rng = seed ? seed : 0x9e3779b9u;
+    InitParticles(&world->particles, MAX_PARTICLES);
+    InitSpatialHash(&world->enemyGrid);
+    ResizeSpatialHash(&world->enemyGrid, width, height, 2.0f * ENEMY_RADIUS);
+    InitFlowField(&world->flowField, width, height, FLOW_CELL_SIZE);
+    InitEntityPool(&world->laserPool, MAX_LASERS, MAX_LASERS);
+    InitEntityPool(&world->enemyPool, DEFAULT_ENEMY_LIMIT, MAX_ENEMIES);
+    InitWaveDirector(&world->director, width, height);
+    world->enemies = malloc(sizeof(Enemy) * world->enemyPool.capacity);
+    world->enemyGridHandles = malloc(sizeof(EntityHandle) * world->enemyPool.capacity);
+    world->enemyLimit = DEFAULT_ENEMY_LIMIT;
+    world->enemyWave = 1;
+    world->fireworkEvery = 1;
+    world->particleBudget = MAX_PARTICLES;
+    ResetWorld(world);
+}
+
+void UnloadWorld(World *world) {
+    UnloadParticles(&world->particles);
+    UnloadSpatialHash(&world->enemyGrid);
+    UnloadFlowField(&world->flowField);
+    UnloadEntityPool(&world->laserPool);
+    UnloadEntityPool(&world->enemyPool);
+    free(world->enemies);
+    free(world->enemyGridHandles);
+    world->enemies = NULL;
+    world->enemyGridHandles = NULL;
+}
+
+void ResetWorld(World *world) {
+    world->player.position = (Vector2){world->width / 2.0f, world->height / 2.0f};
+    world->player.rotation = 0.0f;
+    world->player.direction = (Vector2){1.0f, 0.0f};
+    world->player.speed = 0.0f;
+    ClearEntityPool(&world->laserPool);
+    ClearEntityPool(&world->enemyPool);
+    world->enemiesActive = 0;
+    ClearWaveDirector(&world->director);
+    BeginSpatialHash(&world->enemyGrid);    // Drop stale neighbours used for separation
+    EndSpatialHash(&world->enemyGrid);
+    world->score = 0;
+    world->playerExploded = false;
+}
+
+void StepWorld(World *world, const GameInputs *inputs, float dt) {
+    Spaceship *player = &world->player;
+    Laser *lasers = world->lasers;
+    int screenWidth = world->width;
+    int screenHeight = world->height;
+
+    double mark = 0.0;
+    if (world->clock) {
+        memset(world->phaseTime, 0, sizeof(world->phaseTime));
+        mark = world->clock();
+    }
+
+    world->time += dt;
+    world->collisionTests = 0;
+
+    // Speeds and rates below are tuned per 60 Hz frame; scale them by how many such frames dt covers
+    float frames = dt * 60.0f;
+    StepContext ctx;
+    ctx.world = world;
+    ctx.frames = frames;
+    ctx.useFlowField = false;
+
+    player->prevPosition = player->position;
+    player->prevRotation = player->rotation;
+
+    // Joystick steering: turn towards the stick and match speed to its deflection
+    if (inputs->joystick) {
+        float distance = sqrtf(inputs->stick.x * inputs->stick.x + inputs->stick.y * inputs->stick.y);
+
+        if (distance > 0.2f) {
+            float targetRotation = FastAtan2(inputs->stick.y, inputs->stick.x) * RAD2DEG;
+            float angleDiff = FastAngleDelta(player->rotation, targetRotation);
+            float rotationSpeed = 5.0f * frames;
+            float rotationStep = fminf(fabsf(angleDiff), rotationSpeed) * (angleDiff > 0 ? 1.0f : -1.0f);
+            player->rotation = FastWrapDegrees(player->rotation + rotationStep);
+        }
+
+        float targetSpeed = distance * 5.0f;
+        float acceleration = 0.05f * frames;
+        if (player->speed < targetSpeed) {
+            player->speed += acceleration;
+            if (player->speed > targetSpeed) player->speed = targetSpeed;
+        } else if (player->speed > targetSpeed) {
+            player->speed -= acceleration;
+            if (player->speed < targetSpeed) player->speed = targetSpeed;
+        }
+        player->speed = fmaxf(0.0f, fminf(player->speed, 5.0f));
+    } else {
+        player->speed -= 0.03f * frames;
+        player->speed = fmaxf(0.0f, player->speed);
+    }
+
+    // Game logic
+    if (!world->playerExploded) {
+        // Keyboard controls
+        if (inputs->right) player->rotation += 5.0f * frames;
+        if (inputs->left) player->rotation -= 5.0f * frames;
+        player->rotation = FastWrapDegrees(player->rotation);
+        if (inputs->up) player->speed += 0.1f * frames;
+        if (inputs->down) player->speed -= 0.1f * frames;
+        player->speed = fmaxf(0.0f, fminf(player->speed, 5.0f));
+
+        // Player movement
+        // Heading only changes above, so one sin/cos pair per step serves movement and firing
+        FastDirection(player->rotation, &player->direction.x, &player->direction.y);
+        player->position.x += player->speed * frames * player->direction.x;
+        player->position.y += player->speed * frames * player->direction.y;
+        player->position.x = (player->position.x > screenWidth) ? 0 : (player->position.x < 0) ? screenWidth : player->position.x;
+        player->position.y = (player->position.y > screenHeight) ? 0 : (player->position.y < 0) ? screenHeight : player->position.y;
+
+        // Shoot lasers
+        if (inputs->fire) {
+            int i = AcquireEntity(&world->laserPool);
+            if (i >= 0) {
+                lasers[i].position = (Vector2){player->position.x + LASER_LENGTH * player->direction.x, player->position.y + LASER_LENGTH * player->direction.y};
+                lasers[i].direction = player->direction;
+                lasers[i].speed = 10.0f;
+                lasers[i].active = true;
+            }
+        }
+
+        EndPhase(world, PHASE_PLAYER, &mark);
+
+        // Update lasers
+        int laserCount = world->laserPool.count;
+        ParallelFor(laserCount, WORLD_JOB_GRAIN, UpdateLaserRange, &ctx);
+
+        EndPhase(world, PHASE_LASERS, &mark);
+
+        // Order a wave every two seconds, the director spreads big ones over a few ticks
+        world->enemySpawnTimer += dt;
+        if (world->enemySpawnTimer > 2.0f) {
+            ScheduleSpawnWave(&world->director, 0, WavePattern(world), world->enemyWave);
+            world->enemySpawnTimer = 0.0f;
+        }
+        SpawnDirected(world);
+        Enemy *enemies = world->enemies;   // Spawning may have grown the storage
+
+        // The field rebuilds only when the player crosses into another cell or obstacles change
+        ctx.useFlowField = world->enemiesActive >= FLOW_FIELD_MIN_ENEMIES || world->flowField.blockedCount > 0;
+        if (ctx.useFlowField) UpdateFlowField(&world->flowField, player->position);
+
+        // Update enemy movement towards player
+        ParallelFor(world->enemyPool.count, WORLD_JOB_GRAIN, UpdateEnemyRange, &ctx);
+
+        EndPhase(world, PHASE_ENEMIES, &mark);
+
+        // Bucket enemies into the grid so collision checks only visit neighbouring cells.
+        // Enemies killed since the last rebuild leave first. Ids are entries, valid as they
+        // are for the rest of this step; the next step's separation goes through handles.
+        BeginSpatialHash(&world->enemyGrid);
+        for (int i = 0; i < world->enemyPool.count;) {
+            if (!enemies[i].active) {
+                DespawnEnemy(world, i);
+                continue;
+            }
+            InsertSpatialHash(&world->enemyGrid, i, enemies[i].position);
+            i++;
+        }
+        EndSpatialHash(&world->enemyGrid);
+        SyncEnemyGridHandles(world);
+        EndPhase(world, PHASE_GRID, &mark);
+
+        // Check collisions between lasers and enemies: query in parallel, then apply kills in laser order
+        ParallelFor(laserCount, WORLD_JOB_GRAIN, QueryLaserRange, &ctx);
+        for (int i = 0; i < laserCount; i++) {
+            if (ctx.hitCount[i] > 0) {
+                const int *hits = ctx.hits[i];
+                int hitCount = ctx.hitCount[i];
+                if (hitCount > MAX_LASER_HITS) hitCount = QuerySpatialHash(&world->enemyGrid, lasers[i].position, ENEMY_RADIUS, &hits);
+                for (int h = 0; h < hitCount; h++) {
+                    int j = hits[h];
+                    if (enemies[j].active) {
+                        lasers[i].active = false;
+                        enemies[j].active = false;
+                        world->enemiesActive--;
+                        world->score++;
+                        SpawnExplosion(world, enemies[j].position, 10, YELLOW, true);
+                    }
+                }
+            }
+        }
+
+        // Check collision between player and enemies
+        const int *hits;
+        int hitCount = QuerySpatialHash(&world->enemyGrid, player->position, SHIP_SIZE / 2 + ENEMY_RADIUS, &hits);
+        for (int h = 0; h < hitCount; h++) {
+            int i = hits[h];
+            if (enemies[i].active) {
+                world->playerExploded = true;
+                SpawnExplosion(world, player->position, 20, RED, true);
+            }
+        }
+        world->collisionTests = world->enemyGrid.tests;
+        for (int i = 0; i < laserCount; i++) world->collisionTests += ctx.tests[i];
+
+        // Spent lasers leave, back to front so the last laser moved into a hole is a live one
+        for (int i = laserCount - 1; i >= 0; i--) {
+            if (!lasers[i].active) lasers[i] = lasers[ReleaseEntity(&world->laserPool, i)];
+        }
+        EndPhase(world, PHASE_COLLISIONS, &mark);
+    }
+
+    // Handle "Try Again" button and Tab key
+    if (world->playerExploded && inputs->restart) {
+        ResetWorld(world);
+    }
+
+    // Update particles
+    UpdateParticles(&world->particles, frames, 0.01f * frames);
+
+    // Create background firework effect
+    world->fireworkTimer += dt;
+    if (world->fireworkTimer > 0.1f) {
+        Vector2 position = {WorldRandom(world) % screenWidth, WorldRandom(world) % screenHeight};
+        bool shown = world->fireworkEvery > 0 && world->fireworks % world->fireworkEvery == 0;
+        SpawnExplosion(world, position, 1, WHITE, shown);
+        world->fireworks++;
+        world->fireworkTimer = 0.0f;
+    }
+    EndPhase(world, PHASE_PARTICLES, &mark);
+}
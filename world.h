@@ -0,0 +1,127 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include "raylib.h"
+#include "particles.h"
+#include "director.h"
+#include "spatial.h"
+#include "flowfield.h"
+#include "pool.h"
+
+// Define constants for maximum limits
+#define MAX_LASERS 100         // Lasers in flight at once, storage is preallocated
+#define MAX_ENEMIES 32768       // Enemy storage grows on demand up to this
+#define DEFAULT_ENEMY_LIMIT 10  // Active enemies in a normal game
+#define MAX_PARTICLES 131072    // Particle store grows on demand up to this
+
+// Logical playfield, the window shows it through a camera whatever its own size
+#define WORLD_WIDTH 1920
+#define WORLD_HEIGHT 1080
+
+// Fixed simulation rate, independent of the display refresh rate
+#define WORLD_TICK_RATE 120
+#define WORLD_DT (1.0f / WORLD_TICK_RATE)
+
+// Define constant sizes for game objects (in world units)
+#define SHIP_SIZE 20.0f         // Size of the spaceship
+#define ENEMY_RADIUS 10.0f      // Radius of enemies
+#define LASER_LENGTH 10.0f      // Length of lasers
+#define ENEMY_SEPARATION 20.0f  // Enemies closer than this push apart
+#define FLOW_CELL_SIZE 40.0f    // Enemy flow field resolution
+
+// Define structures for game objects
+typedef struct {
+    Vector2 position;   // Position of the spaceship
+    float rotation;     // Rotation angle in degrees, kept in [0, 360)
+    Vector2 direction;  // Unit vector along rotation, refreshed once per step
+    float speed;        // Movement speed
+    Vector2 prevPosition;   // Position and rotation before the last step, for render interpolation
+    float prevRotation;
+} Spaceship;
+
+typedef struct {
+    Vector2 position;   // Position of the laser
+    Vector2 direction;  // Unit vector it flies along, copied from the ship when fired
+    float speed;        // Movement speed
+    bool active;        // False once spent, despawned at the end of the step
+} Laser;
+
+typedef struct {
+    Vector2 position;   // Position of the enemy
+    float speed;        // Movement speed
+    bool active;        // False once killed, despawned at the next grid rebuild
+    Vector2 prevPosition;   // Position before the last step, for render interpolation
+} Enemy;
+
+// Player inputs for one simulation step, filled by the window frontend or a bot
+typedef struct {
+    bool left;          // Turn left (KEY_LEFT)
+    bool right;         // Turn right (KEY_RIGHT)
+    bool up;            // Accelerate (KEY_UP)
+    bool down;          // Brake (KEY_DOWN)
+    bool fire;          // Fire a laser this step (SPACE or new fire button touch)
+    bool restart;       // Restart after game over (TAB or "Nah, I'd Win")
+    bool joystick;      // Whether the touch joystick is held
+    Vector2 stick;      // Joystick offset from its center, scaled so length <= 1
+} GameInputs;
+
+// StepWorld phases, timed individually when the world has a clock
+typedef enum {
+    PHASE_PLAYER = 0,   // Steering, movement and firing
+    PHASE_LASERS,       // Laser movement
+    PHASE_ENEMIES,      // Enemy spawn and seek
+    PHASE_GRID,         // Enemy spatial hash rebuild
+    PHASE_COLLISIONS,   // Laser and player hit tests
+    PHASE_PARTICLES,    // Particle update and fireworks
+    WORLD_PHASE_COUNT
+} WorldPhase;
+
+typedef double (*WorldClock)(void);    // Seconds since any fixed point
+
+// Complete state of one game, no window or global state involved
+typedef struct {
+    int width;                          // Playfield width
+    int height;                         // Playfield height
+    Spaceship player;
+    Laser lasers[MAX_LASERS];           // Packed, [0, laserPool.count) are in flight
+    EntityPool laserPool;
+    Enemy *enemies;                     // Packed, [0, enemyPool.count) are alive or killed since the last grid rebuild
+    EntityPool enemyPool;               // Storage grows with it
+    int enemiesActive;
+    int enemyLimit;                     // Most enemies alive at once, DEFAULT_ENEMY_LIMIT unless changed
+    int enemyWave;                      // Enemies ordered every two seconds, 1 unless changed
+    WaveDirector director;              // Spawn orders in flight, placed outside a safe radius around the player
+    FlowField flowField;                // Enemy steering towards the player, optional static obstacles
+    ParticleSystem particles;           // Fireworks and explosion sparks, heap backed
+    SpatialHash enemyGrid;              // Enemy broad-phase, rebuilt every step
+    EntityHandle *enemyGridHandles;     // Per grid id (entry at the rebuild) its enemy's handle, enemyPool.capacity of them
+    int score;
+    bool playerExploded;
+    float enemySpawnTimer;              // Seconds since last enemy spawn
+    float fireworkTimer;                // Seconds since last background firework
+    int fireworks;                      // Background fireworks launched so far
+    float time;                         // Total simulated seconds (drives title color cycle)
+    unsigned int rng;                   // Per-world random state, never zero
+
+    // Effects settings, lowered by the game's quality governor under load. Only change which
+    // particles exist, never the gameplay state or random sequence. Not part of snapshots.
+    int fireworkEvery;                  // Show one background firework in this many, 0 shows none, 1 by default
+    int particleBudget;                 // Sparks spawn only while fewer are alive, MAX_PARTICLES by default
+
+    // Optional profiling hook, InitWorld leaves it unset
+    WorldClock clock;
+    double phaseTime[WORLD_PHASE_COUNT];    // Seconds spent in each phase by the last step
+    int collisionTests;                     // Enemy distance checks made by the last step
+} World;
+
+void InitWorld(World *world, int width, int height, unsigned int seed);
+void UnloadWorld(World *world);                             // Free particle and grid storage
+void ResetWorld(World *world);                              // Restart the round, particles keep flying
+void StepWorld(World *world, const GameInputs *inputs, float dt);       // Normally called with WORLD_DT
+int WorldRandom(World *world);                              // rand() replacement, 0..0x7fffffff
+int SpawnEnemies(World *world, int count);                  // Up to count right away at random spots clear of the player, returns how many
+void DespawnEnemy(World *world, int index);                 // O(1), the last enemy moves into index
+void SyncEnemyGridHandles(World *world);                    // After a grid rebuild: handles for the ids it holds
+void AdvanceLasers(Laser *lasers, int count, float frames, int width, int height);     // Move and cull, the PHASE_LASERS kernel
+
+#endif // WORLD_H